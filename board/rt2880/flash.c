@@ -694,6 +694,9 @@ int erase_all_chip(flash_info_t *info, int s_first, int s_last)
 		return 1;
 	}
 
+	if (flash_gen_bump(info->start[0], info->size) != 0)
+		return 1;
+
 	switch (info->flash_id & FLASH_TYPEMASK) {
 	case FLASH_INTEL800B:
 	case FLASH_INTEL160B:
@@ -821,6 +824,11 @@ int	flash_erase(flash_info_t *info, int s_first, int s_last)
 		return 1;
 	}
 
+	if (flash_gen_bump(info->start[s_first],
+		((s_last == info->sector_count - 1) ? info->start[0] + info->size :
+		 info->start[s_last + 1]) - info->start[s_first]) != 0)
+		return 1;
+
 	switch (info->flash_id & FLASH_TYPEMASK) {
 	case FLASH_INTEL800B:
 	case FLASH_INTEL160B:
@@ -1076,6 +1084,10 @@ int write_buff(flash_info_t *info, uchar *src, ulong addr, ulong cnt)
 			rt2880_flash_start_t = get_timer(0);
 		}
 
+		/* nothing to program if the word already holds the data */
+		if (*(FPWV *)addr == data)
+			continue;
+
 		/* write one word to the flash */
 		switch (info->flash_id & FLASH_VENDMASK) {
 		case FLASH_MAN_AMD:
@@ -36,6 +36,11 @@
 
 #include <environment.h>
 #include <asm/byteorder.h>
+#include <asm/addrspace.h>
+#include <gdma_api.h>
+#if defined (CFG_ENV_IS_IN_FLASH)
+#include <flash.h>
+#endif
 
  /*cmd_boot.c*/
  extern int do_reset (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[]);
@@ -270,6 +275,16 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 	data = addr + sizeof(image_header_t);
 	len  = ntohl(hdr->ih_size);
 
+	if (hdr->ih_comp & IH_COMP_CHUNKED) {
+		if (hdr->ih_type == IH_TYPE_MULTI) {
+			puts ("Chunked Multi-File Images not supported\n");
+			SHOW_BOOT_PROGRESS (-3);
+			return 1;
+		}
+		/* data is verified and loaded chunk by chunk below */
+		goto chunked;
+	}
+
 #ifdef CONFIG_HAS_DATAFLASH
 	if (addr_dataflash(addr)){
 		read_dataflash(data, len, (char *)CFG_LOAD_ADDR);
@@ -292,7 +307,9 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 #else //CFG_ENV_IS_IN_FLASH
 #endif
 
-	if (verify) {
+	if (verify && image_verify_cached(addr, checksum, len)) {
+		puts ("   Verifying Checksum ... OK (cached)\n");
+	} else if (verify) {
 		puts ("   Verifying Checksum ... ");
 		if (crc32 (0, (char *)data, len) != ntohl(hdr->ih_dcrc)) {
 			printf ("Bad Data CRC\n");
@@ -300,9 +317,11 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			return 1;
 		}
 		puts ("OK\n");
+		image_verify_record(addr, checksum, len);
 	}
 	SHOW_BOOT_PROGRESS (4);
 
+chunked:
 	len_ptr = (ulong *)data;
 
 #if defined(__PPC__)
@@ -375,10 +394,31 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 	dcache_disable();
 #endif
 
+	if (hdr->ih_comp & IH_COMP_CHUNKED) {
+		/* every chunk carries its own CRC, always checked as it is read */
+		if (chunked_image_load(addr, hdr, &len) != 0) {
+			puts ("must RESET board to recover\n");
+			SHOW_BOOT_PROGRESS (-6);
+			udelay(100000);
+			do_reset (cmdtp, flag, argc, argv);
+		}
+		if (verify)
+			image_verify_record(addr, checksum, ntohl(hdr->ih_size));
+	} else
 	switch (hdr->ih_comp) {
 	case IH_COMP_NONE:
-		if(ntohl(hdr->ih_load) == addr) {
+		if(ntohl(hdr->ih_load) == addr || ntohl(hdr->ih_load) == data) {
 			printf ("   XIP %s ... ", name);
+#if defined (CFG_ENV_IS_IN_FLASH)
+		} else if (KSEG1ADDR(ntohl(hdr->ih_load)) == KSEG1ADDR(data) &&
+			   addr2info(KSEG1ADDR(data)) != NULL) {
+			/*
+			 * Linked for the KSEG0 alias of where it sits in NOR:
+			 * run in place.  K0 was made cacheable above, so it
+			 * executes cached.  Any other load address is copied.
+			 */
+			printf ("   XIP %s from flash ... ", name);
+#endif
 		} else {
 #if defined(CONFIG_HW_WATCHDOG) || defined(CONFIG_WATCHDOG)
 			size_t l = len;
@@ -396,7 +436,7 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 				l -= tail;
 			}
 #else	/* !(CONFIG_HW_WATCHDOG || CONFIG_WATCHDOG) */
-			memmove ((void *) ntohl(hdr->ih_load), (uchar *)data, len);
+			dma_memcpy ((void *) ntohl(hdr->ih_load), (uchar *)data, len);
 #endif	/* CONFIG_HW_WATCHDOG || CONFIG_WATCHDOG */
 		}
 		break;
@@ -563,6 +603,149 @@ U_BOOT_CMD(
  	"\t'arg' can be the address of an initrd image\n"
 );
 
+#ifdef RT2880_U_BOOT_CMD_OPEN
+extern unsigned long mips_cpu_feq;
+
+static int dbench_once (image_header_t *hdr, uchar *dst, uchar *src,
+			ulong len, ulong *outlen)
+{
+	switch (hdr->ih_comp) {
+	case IH_COMP_NONE:
+		memmove (dst, src, len);
+		*outlen = len;
+		return 0;
+	case IH_COMP_GZIP:
+		*outlen = len;
+		return gunzip (dst, 0x800000, src, outlen);
+#ifdef CONFIG_BZIP2
+	case IH_COMP_BZIP2:
+		{
+			uint unc_len = 0x800000;
+			int i;
+
+			i = BZ2_bzBuffToBuffDecompress ((char *)dst, &unc_len,
+					(char *)src, len,
+					CFG_MALLOC_LEN < (4096 * 1024), 0);
+			*outlen = unc_len;
+			return (i == BZ_OK) ? 0 : i;
+		}
+#endif /* CONFIG_BZIP2 */
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA:
+		{
+			unsigned int destLen = 0;
+			int i;
+
+			i = lzmaBuffToBuffDecompress ((char *)dst, &destLen,
+					(char *)src, len);
+			*outlen = destLen;
+			return i;
+		}
+#endif /* CONFIG_LZMA */
+	default:
+		printf ("Unimplemented compression type %d\n", hdr->ih_comp);
+		return -1;
+	}
+}
+
+/* print n/d with two decimals */
+static void dbench_print_ratio (ulong n, ulong d)
+{
+	ulong q = n / d, r = n % d;
+
+	printf ("%lu.%02lu", q, r * 100 / d);
+}
+
+/*
+ * Decompress the image at 'addr' 'count' times and report the best run.
+ * CP0 Count runs at half the CPU clock.
+ */
+int do_dbench (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	image_header_t *hdr = &header;
+	ulong addr, dst, len, outlen = 0;
+	ulong count = 10, i, t, best = ~0UL, total_ms = 0;
+	ulong base, peak, heap = 0, abase, apeak, arena = 0;
+	ulong tick_per_us = (mips_cpu_feq / 2) / 1000000;
+	uchar *data;
+
+	if (argc < 2) {
+		printf ("Usage:\n%s\n", cmdtp->usage);
+		return 1;
+	}
+	addr = simple_strtoul (argv[1], NULL, 16);
+	if (argc > 2)
+		count = simple_strtoul (argv[2], NULL, 10);
+	if (count == 0)
+		count = 1;
+
+	memmove (hdr, (char *)addr, sizeof(image_header_t));
+	if (ntohl(hdr->ih_magic) != IH_MAGIC) {
+		puts ("Bad Magic Number\n");
+		return 1;
+	}
+	if (hdr->ih_comp & IH_COMP_CHUNKED) {
+		puts ("Chunked images are not supported\n");
+		return 1;
+	}
+	data = (uchar *)addr + sizeof(image_header_t);
+	len = ntohl(hdr->ih_size);
+	dst = (argc > 3) ? simple_strtoul (argv[3], NULL, 16) : ntohl(hdr->ih_load);
+
+	printf ("## Decompressing %lu bytes at %08lx to %08lx, %lu times\n",
+		len, (ulong)data, dst, count);
+
+	for (i = 0; i < count; i++) {
+		malloc_peak_reset ();
+		arena_peak_reset ();
+		base = malloc_usage (NULL);
+		abase = arena_usage (NULL, NULL);
+		t = get_timer (0);
+		if (dbench_once (hdr, (uchar *)dst, data, len, &outlen) != 0) {
+			puts ("Decompression failed\n");
+			return 1;
+		}
+		t = get_timer (t);
+		malloc_usage (&peak);
+		arena_usage (&apeak, NULL);
+
+		if (t < best)
+			best = t;
+		total_ms += t / (tick_per_us * 1000);
+		if (peak - base > heap)
+			heap = peak - base;
+		if (apeak - abase > arena)
+			arena = apeak - abase;
+	}
+	if (outlen < 2) {
+		puts ("Nothing decompressed\n");
+		return 1;
+	}
+	if (best < tick_per_us)
+		best = tick_per_us;
+
+	printf ("   in:  %lu bytes, ", len);
+	dbench_print_ratio (len, best / tick_per_us);
+	printf (" MB/s\n   out: %lu bytes, ", outlen);
+	dbench_print_ratio (outlen, best / tick_per_us);
+	printf (" MB/s, ");
+	dbench_print_ratio (best, outlen / 2);
+	printf (" cycles/byte\n");
+	printf ("   best %lu us, total %lu ms, peak heap %lu + arena %lu bytes\n",
+		best / tick_per_us, total_ms, heap, arena);
+	return 0;
+}
+
+U_BOOT_CMD(
+	dbench,	4,	1,	do_dbench,
+	"dbench  - decompression benchmark\n",
+	"addr [count [dest]]\n"
+	"    - decompress the image at 'addr' 'count' times (default 10)\n"
+	"      to 'dest' (default: its load address) and report MB/s,\n"
+	"      CPU cycles per byte and peak heap and arena use\n"
+);
+#endif /* RT2880_U_BOOT_CMD_OPEN */
+
 #ifdef CONFIG_SILENT_CONSOLE
 static void
 fixup_silent_linux ()
@@ -875,7 +1058,7 @@ do_bootm_linux (cmd_tbl_t *cmdtp, int flag,
 			}
 		}
 #else	/* !(CONFIG_HW_WATCHDOG || CONFIG_WATCHDOG) */
-		memmove ((void *)initrd_start, (void *)data, len);
+		dma_memcpy ((void *)initrd_start, (void *)data, len);
 #endif	/* CONFIG_HW_WATCHDOG || CONFIG_WATCHDOG */
 		puts ("OK\n");
 	    }
@@ -1336,7 +1519,7 @@ print_type (image_header_t *hdr)
 	default:		type = "Unknown Image";		break;
 	}
 
-	switch (hdr->ih_comp) {
+	switch (hdr->ih_comp & ~IH_COMP_CHUNKED) {
 	case IH_COMP_NONE:	comp = "uncompressed";		break;
 	case IH_COMP_GZIP:	comp = "gzip compressed";	break;
 	case IH_COMP_BZIP2:	comp = "bzip2 compressed";	break;
@@ -1344,7 +1527,8 @@ print_type (image_header_t *hdr)
 	default:		comp = "unknown compression";	break;
 	}
 
-	printf ("%s %s %s (%s)", arch, os, type, comp);
+	printf ("%s %s %s (%s%s)", arch, os, type, comp,
+		(hdr->ih_comp & IH_COMP_CHUNKED) ? ", chunked" : "");
 }
 
 #define	ZALLOC_ALIGNMENT	16
@@ -1356,14 +1540,14 @@ static void *zalloc(void *x, unsigned items, unsigned size)
 	size *= items;
 	size = (size + ZALLOC_ALIGNMENT - 1) & ~(ZALLOC_ALIGNMENT - 1);
 
-	p = malloc (size);
+	p = arena_alloc (size);
 
 	return (p);
 }
 
 static void zfree(void *x, void *addr, unsigned nb)
 {
-	free (addr);
+	arena_free (addr);
 }
 
 #define HEAD_CRC	2
@@ -1378,6 +1562,7 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 {
 	z_stream s;
 	int r, i, flags;
+	ulong mark;
 
 	/* skip header */
 	i = 10;
@@ -1409,9 +1594,12 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	s.outcb = Z_NULL;
 #endif	/* CONFIG_HW_WATCHDOG */
 
+	/* inflate state and window all come from the arena, dropped at once */
+	mark = arena_mark ();
 	r = inflateInit2(&s, -MAX_WBITS);
 	if (r != Z_OK) {
 		printf ("Error: inflateInit2() returned %d\n", r);
+		arena_release (mark);
 		return (-1);
 	}
 	s.next_in = src + i;
@@ -1421,10 +1609,13 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	r = inflate(&s, Z_FINISH);
 	if (r != Z_OK && r != Z_STREAM_END) {
 		printf ("Error: inflate() returned %d\n", r);
+		inflateEnd(&s);
+		arena_release (mark);
 		return (-1);
 	}
 	*lenp = s.next_out - (unsigned char *) dst;
 	inflateEnd(&s);
+	arena_release (mark);
 
 	return (0);
 }
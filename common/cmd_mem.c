@@ -29,6 +29,9 @@
 
 #include <common.h>
 #include <command.h>
+#include <gdma_api.h>
+#include <malloc.h>
+#include <asm/addrspace.h>
 #if (CONFIG_COMMANDS & CFG_CMD_MMC)
 #include <mmc.h>
 #endif
@@ -1072,6 +1075,98 @@ int do_mem_crc (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 #endif
 #endif	/* CONFIG_CRC32_VERIFY */
 
+#ifdef RT2880_U_BOOT_CMD_OPEN
+extern unsigned long mips_cpu_feq;
+
+/*
+ * Run 'what' (0: memcpy, 1: memset, 2: memmove) over 'len' bytes 'count'
+ * times and print the best run in MB/s.  CP0 Count runs at half the CPU
+ * clock.
+ */
+static void mbw_run (int what, ulong dst, ulong src, ulong len, ulong count)
+{
+	static const char *name[] = { "memcpy", "memset", "memmove" };
+	ulong tick_per_us = (mips_cpu_feq / 2) / 1000000;
+	ulong i, t, best = ~0UL, us;
+
+	for (i = 0; i < count; i++) {
+		t = get_timer (0);
+		if (what == 0)
+			memcpy ((void *)dst, (void *)src, len);
+		else if (what == 1)
+			memset ((void *)dst, 0x5a, len);
+		else
+			memmove ((void *)dst, (void *)src, len);
+		t = get_timer (t);
+		if (t < best)
+			best = t;
+	}
+	us = best / tick_per_us;
+	if (us == 0)
+		us = 1;
+	printf ("   %-8s %8lu us  %4lu.%lu MB/s\n", name[what], us,
+		len / us, ((len % us) * 10) / us);
+}
+
+/* Memory Bandwidth
+ *
+ * Syntax:
+ *	mbw {addr} {len} [count]
+ */
+int do_mem_mbw (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	ulong addr, len, count = 10;
+
+	if (argc < 3) {
+		printf ("Usage:\n%s\n", cmdtp->usage);
+		return 1;
+	}
+	addr = simple_strtoul (argv[1], NULL, 16) + base_address;
+	len = simple_strtoul (argv[2], NULL, 16);
+	if (argc > 3)
+		count = simple_strtoul (argv[3], NULL, 10);
+	if (len == 0 || count == 0) {
+		printf ("Usage:\n%s\n", cmdtp->usage);
+		return 1;
+	}
+
+	printf ("## %lu bytes at %08lx ... %08lx, best of %lu\n",
+		len, addr, addr + 2 * len - 1, count);
+	mbw_run (0, addr + len, addr, len, count);
+	mbw_run (1, addr, 0, len, count);
+	/* overlapping, so memmove has to copy backwards */
+	mbw_run (2, addr + len / 2 + 4, addr, len, count);
+	return 0;
+}
+#endif
+
+/* Heap Information
+ *
+ * Syntax:
+ *	meminfo
+ */
+int do_mem_info (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	ulong used, peak, total, chunks, largest, fallbacks;
+
+	used = malloc_usage (&peak);
+	largest = malloc_free_stats (&total, &chunks);
+	printf ("heap:  %d kB, %lu in use, peak %lu (since reset), max %lu\n",
+		CFG_MALLOC_LEN >> 10, used, peak, malloc_max_usage ());
+	printf ("       %lu free in %lu chunks, largest %lu", total, chunks, largest);
+	if (total)
+		printf (" (%lu%% fragmented)", 100 - (largest * 100) / total);
+	putc ('\n');
+
+	used = arena_usage (&peak, &fallbacks);
+#ifdef CFG_ARENA_LEN
+	printf ("arena: %d kB, %lu in use, peak %lu, %lu requests fell back to heap\n",
+		CFG_ARENA_LEN >> 10, used, peak, fallbacks);
+#endif
+	malloc_trace_print ();
+	return 0;
+}
+
 /**************************************************/
 #if (CONFIG_COMMANDS & CFG_CMD_MEMORY)
 U_BOOT_CMD(
@@ -1158,7 +1253,22 @@ U_BOOT_CMD(
 	"[start [end [pattern]]]\n"
 	"    - simple RAM read/write test\n"
 );
+
+U_BOOT_CMD(
+	mbw,     4,     1,     do_mem_mbw,
+	"mbw     - memory bandwidth test\n",
+	"address length [count]\n"
+	"    - time memcpy, memset and memmove of 'length' bytes at 'address'\n"
+	"      (uses 2 * 'length' bytes) and report the best of 'count' runs\n"
+);
 #endif
+
+U_BOOT_CMD(
+	meminfo,  1,    1,     do_mem_info,
+	"meminfo - show heap usage and fragmentation\n",
+	"\n    - heap use, peak, free chunks and the largest one,\n"
+	"      arena use and, with CFG_MALLOC_TRACE, per call site statistics\n"
+);
 #ifdef CONFIG_MX_CYCLIC
 U_BOOT_CMD(
 	mdc,     4,     1,      do_mem_mdc,
@@ -1177,6 +1287,17 @@ U_BOOT_CMD(
 #endif	/* CFG_CMD_MEMORY */
 
 #ifdef CFG_ENV_IS_IN_FLASH
+/* [addr, addr + len) lies in SDRAM, through either KSEG0 or KSEG1 */
+static int addr_in_sdram(ulong addr, ulong len)
+{
+	DECLARE_GLOBAL_DATA_PTR;
+	ulong start = KSEG0ADDR(gd->bd->bi_memstart);
+
+	addr = KSEG0ADDR(addr);
+	return (addr >= start && len <= gd->bd->bi_memsize &&
+		addr - start <= gd->bd->bi_memsize - len);
+}
+
 int do_mem_cp ( cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 {
 	ulong	addr = 0, dest = 0, count = 0;
@@ -1386,6 +1507,16 @@ RT2880_START_WRITE_FLASH:
 	}
 #endif
 
+	/*
+	 * large word copies within SDRAM go to the DMA engine; .b and .w
+	 * copies and anything touching registers keep their access width
+	 */
+	if (size == 4 && count * size >= GDMA_MIN_LEN &&
+	    addr_in_sdram(addr, count * size) && addr_in_sdram(dest, count * size)) {
+		dma_memcpy ((void *)dest, (void *)addr, count * size);
+		return 0;
+	}
+
 	while (count-- > 0) {
 		if (size == 4)
 			*((ulong  *)dest) = *((ulong  *)addr);
@@ -935,6 +935,7 @@ struct mallinfo mALLINFo();
 /* ---------- To make a malloc.h, end cutting here ------------ */
 #else				/* Moved to malloc.h */
 
+#define MALLOC_TRACE_IMPL	/* the real malloc() is defined here */
 #include <malloc.h>
 #if 0
 #if __STD_C
@@ -1598,6 +1599,14 @@ static unsigned int max_n_mmaps = 0;
 static unsigned long max_mmapped_mem = 0;
 #endif
 
+/*
+ * Bytes in chunks currently handed out by malloc() and realloc(), and
+ * their high-water mark since the last malloc_peak_reset().
+ */
+static unsigned long malloc_in_use = 0;
+static unsigned long malloc_peak = 0;
+static unsigned long malloc_max = 0;	/* never reset */
+
 
 
 /*
@@ -2129,6 +2138,21 @@ static void malloc_extend_top(nb) INTERNAL_SIZE_T nb;
 
 */
 
+static void malloc_grow(unsigned long bytes)
+{
+  malloc_in_use += bytes;
+  if (malloc_in_use > malloc_peak)
+    malloc_peak = malloc_in_use;
+  if (malloc_in_use > malloc_max)
+    malloc_max = malloc_in_use;
+}
+
+static Void_t *malloc_account(mchunkptr p)
+{
+  malloc_grow(chunksize(p));
+  return chunk2mem(p);
+}
+
 #if __STD_C
 Void_t* mALLOc(size_t bytes)
 #else
@@ -2177,7 +2201,7 @@ Void_t* mALLOc(bytes) size_t bytes;
       unlink(victim, bck, fwd);
       set_inuse_bit_at_offset(victim, victim_size);
       check_malloced_chunk(victim, nb);
-      return chunk2mem(victim);
+      return malloc_account(victim);
     }
 
     idx += 2; /* Set for bin scan below. We've already scanned 2 bins. */
@@ -2204,7 +2228,7 @@ Void_t* mALLOc(bytes) size_t bytes;
 	unlink(victim, bck, fwd);
 	set_inuse_bit_at_offset(victim, victim_size);
 	check_malloced_chunk(victim, nb);
-	return chunk2mem(victim);
+	return malloc_account(victim);
       }
     }
 
@@ -2227,7 +2251,7 @@ Void_t* mALLOc(bytes) size_t bytes;
       set_head(remainder, remainder_size | PREV_INUSE);
       set_foot(remainder, remainder_size);
       check_malloced_chunk(victim, nb);
-      return chunk2mem(victim);
+      return malloc_account(victim);
     }
 
     clear_last_remainder;
@@ -2236,7 +2260,7 @@ Void_t* mALLOc(bytes) size_t bytes;
     {
       set_inuse_bit_at_offset(victim, victim_size);
       check_malloced_chunk(victim, nb);
-      return chunk2mem(victim);
+      return malloc_account(victim);
     }
 
     /* Else place in bin */
@@ -2291,7 +2315,7 @@ Void_t* mALLOc(bytes) size_t bytes;
 	    set_head(remainder, remainder_size | PREV_INUSE);
 	    set_foot(remainder, remainder_size);
 	    check_malloced_chunk(victim, nb);
-	    return chunk2mem(victim);
+	    return malloc_account(victim);
 	  }
 
 	  else if (remainder_size >= 0)  /* take */
@@ -2299,7 +2323,7 @@ Void_t* mALLOc(bytes) size_t bytes;
 	    set_inuse_bit_at_offset(victim, victim_size);
 	    unlink(victim, bck, fwd);
 	    check_malloced_chunk(victim, nb);
-	    return chunk2mem(victim);
+	    return malloc_account(victim);
 	  }
 
 	}
@@ -2347,7 +2371,7 @@ Void_t* mALLOc(bytes) size_t bytes;
     /* If big and would otherwise need to extend, try to use mmap instead */
     if ((unsigned long)nb >= (unsigned long)mmap_threshold &&
 	(victim = mmap_chunk(nb)) != 0)
-      return chunk2mem(victim);
+      return malloc_account(victim);
 #endif
 
     /* Try to extend */
@@ -2361,7 +2385,7 @@ Void_t* mALLOc(bytes) size_t bytes;
   top = chunk_at_offset(victim, nb);
   set_head(top, remainder_size | PREV_INUSE);
   check_malloced_chunk(victim, nb);
-  return chunk2mem(victim);
+  return malloc_account(victim);
 
 }
 
@@ -2412,6 +2436,7 @@ void fREe(mem) Void_t* mem;
 
   p = mem2chunk(mem);
   hd = p->size;
+  malloc_in_use -= chunksize(p);
 
 #if HAVE_MMAP
   if (hd & IS_MMAPPED)                       /* release mmapped memory. */
@@ -2603,6 +2628,7 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 	  top = chunk_at_offset(oldp, nb);
 	  set_head(top, (newsize - nb) | PREV_INUSE);
 	  set_head_size(oldp, nb);
+	  malloc_grow(nb - oldsize);
 	  return chunk2mem(oldp);
 	}
       }
@@ -2645,6 +2671,7 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 	    top = chunk_at_offset(newp, nb);
 	    set_head(top, (newsize - nb) | PREV_INUSE);
 	    set_head_size(newp, nb);
+	    malloc_grow(nb - oldsize);
 	    return newmem;
 	  }
 	}
@@ -2686,6 +2713,7 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 
     if ( (newp = mem2chunk(newmem)) == next_chunk(oldp))
     {
+      malloc_in_use -= chunksize(newp);	/* counted again at split */
       newsize += chunksize(newp);
       newp = oldp;
       goto split;
@@ -2700,6 +2728,8 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 
  split:  /* split off extra room in old or expanded chunk */
 
+  malloc_in_use -= oldsize;
+
   if (newsize - nb >= MINSIZE) /* split off remainder */
   {
     remainder = chunk_at_offset(newp, nb);
@@ -2707,12 +2737,15 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
     set_head_size(newp, nb);
     set_head(remainder, remainder_size | PREV_INUSE);
     set_inuse_bit_at_offset(remainder, remainder_size);
+    malloc_grow(nb);
+    malloc_in_use += remainder_size;	/* free() takes it off again */
     fREe(chunk2mem(remainder)); /* let free() deal with it */
   }
   else
   {
     set_head_size(newp, newsize);
     set_inuse_bit_at_offset(newp, newsize);
+    malloc_grow(newsize);
   }
 
   check_inuse_chunk(newp);
@@ -3152,6 +3185,221 @@ struct mallinfo mALLINFo()
 }
 #endif	/* 0 */
 
+/*
+  malloc_usage returns the number of bytes currently handed out and,
+  if peak is not NULL, the most that was in use at any time since the
+  last call to malloc_peak_reset.
+*/
+
+unsigned long malloc_usage(unsigned long *peak)
+{
+  if (peak)
+    *peak = malloc_peak;
+  return malloc_in_use;
+}
+
+void malloc_peak_reset(void)
+{
+  malloc_peak = malloc_in_use;
+}
+
+unsigned long malloc_max_usage(void)
+{
+  return malloc_max;
+}
+
+/*
+  malloc_free_stats walks the bins and returns the largest free chunk,
+  the top chunk included.  The total free bytes and number of free
+  chunks go to *total and *chunks.  Heap not yet claimed through sbrk
+  is not counted.
+*/
+
+unsigned long malloc_free_stats(unsigned long *total, unsigned long *chunks)
+{
+  unsigned long largest, sz, sum, n;
+  mbinptr b;
+  mchunkptr p;
+  int i;
+
+  largest = sum = chunksize(top);
+  n = 1;
+  for (i = 1; i < NAV; ++i)
+  {
+    b = bin_at(i);
+    for (p = last(b); p != b; p = p->bk)
+    {
+      sz = chunksize(p);
+      sum += sz;
+      n++;
+      if (sz > largest)
+	largest = sz;
+    }
+  }
+  if (total)
+    *total = sum;
+  if (chunks)
+    *chunks = n;
+  return largest;
+}
+
+/*
+  Bump arena for big, short lived buffers such as decompressor state
+  and windows, so they neither fragment nor exhaust the general heap.
+  Allocation just advances a pointer.  A user takes arena_mark() before
+  its first allocation and hands it to arena_release() when done, which
+  drops everything allocated since in one go; arena_free() only matters
+  for requests that did not fit, or all of them when the board reserves
+  no arena, as those fall back to malloc().
+*/
+
+#define ARENA_ALIGN	16
+
+static unsigned long arena_start = 0;
+static unsigned long arena_end = 0;
+static unsigned long arena_ptr = 0;
+static unsigned long arena_peak = 0;
+static unsigned long arena_fallbacks = 0;
+
+void arena_init(unsigned long start, unsigned long len)
+{
+  arena_start = arena_ptr = (start + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+  arena_end = start + len;
+}
+
+void *arena_alloc(size_t bytes)
+{
+  unsigned long p = arena_ptr;
+  unsigned long n = (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+  if (arena_start == 0 || n > arena_end - p)
+  {
+    arena_fallbacks++;
+    return mALLOc(bytes);
+  }
+  arena_ptr = p + n;
+  if (arena_ptr - arena_start > arena_peak)
+    arena_peak = arena_ptr - arena_start;
+  return (void *)p;
+}
+
+void arena_free(void *mem)
+{
+  unsigned long p = (unsigned long)mem;
+
+  if (p < arena_start || p >= arena_end)
+    fREe(mem);
+}
+
+unsigned long arena_mark(void)
+{
+  return arena_ptr;
+}
+
+void arena_release(unsigned long mark)
+{
+  if (mark >= arena_start && mark <= arena_ptr)
+    arena_ptr = mark;
+}
+
+/*
+  arena_usage returns the bytes currently taken from the arena; the
+  high-water mark since arena_peak_reset and the number of requests
+  that went to malloc() instead go to *peak and *fallbacks.
+*/
+
+unsigned long arena_usage(unsigned long *peak, unsigned long *fallbacks)
+{
+  if (peak)
+    *peak = arena_peak;
+  if (fallbacks)
+    *fallbacks = arena_fallbacks;
+  return arena_ptr - arena_start;
+}
+
+void arena_peak_reset(void)
+{
+  arena_peak = arena_ptr - arena_start;
+}
+
+#ifdef CFG_MALLOC_TRACE
+/*
+  Per call site statistics: requests, bytes asked for, the largest
+  request and failures, plus a power of two histogram of request sizes
+  over all sites.
+*/
+
+#ifndef CFG_MALLOC_TRACE_SITES
+#define CFG_MALLOC_TRACE_SITES	32
+#endif
+#define TRACE_BUCKETS	20	/* 1 byte ... 512 kB and up */
+
+static struct malloc_site {
+  const char *file;
+  int line;
+  unsigned long calls, bytes, largest, fails;
+} malloc_sites[CFG_MALLOC_TRACE_SITES];
+static unsigned long malloc_hist[TRACE_BUCKETS];
+static unsigned long malloc_untracked;
+
+void *malloc_trace(size_t bytes, const char *file, int line)
+{
+  struct malloc_site *s;
+  void *p = mALLOc(bytes);
+  int i;
+
+  for (i = 0; bytes >> (i + 1) && i < TRACE_BUCKETS - 1; i++)
+    ;
+  malloc_hist[i]++;
+
+  for (i = 0, s = malloc_sites; i < CFG_MALLOC_TRACE_SITES; i++, s++)
+  {
+    if (s->file == NULL)
+    {
+      s->file = file;
+      s->line = line;
+    }
+    if (s->file == file && s->line == line)
+      break;
+  }
+  if (i == CFG_MALLOC_TRACE_SITES)
+  {
+    malloc_untracked++;
+    return p;
+  }
+
+  s->calls++;
+  s->bytes += bytes;
+  if (bytes > s->largest)
+    s->largest = bytes;
+  if (p == NULL)
+    s->fails++;
+  return p;
+}
+
+void malloc_trace_print(void)
+{
+  struct malloc_site *s;
+  int i;
+
+  printf("%-28s %8s %10s %8s %6s\n", "site", "calls", "bytes", "largest", "fails");
+  for (i = 0, s = malloc_sites; i < CFG_MALLOC_TRACE_SITES && s->file; i++, s++)
+    printf("%-22.22s:%-5d %8lu %10lu %8lu %6lu\n", s->file, s->line,
+	   s->calls, s->bytes, s->largest, s->fails);
+  if (malloc_untracked)
+    printf("(%lu calls from sites beyond the table)\n", malloc_untracked);
+
+  puts("request size histogram:\n");
+  for (i = 0; i < TRACE_BUCKETS; i++)
+    if (malloc_hist[i])
+      printf("  >= %7lu: %lu\n", 1UL << i, malloc_hist[i]);
+}
+#else
+void malloc_trace_print(void)
+{
+}
+#endif /* CFG_MALLOC_TRACE */
+
 
 
 
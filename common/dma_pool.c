@@ -0,0 +1,131 @@
+/*
+ * Fixed size pools for DMA descriptors and buffers
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The backing store is malloc()ed once, written back and invalidated
+ * from the D-cache, and from then on only touched through KSEG1.  Free
+ * blocks are chained through their first word, so alloc and free are
+ * O(1).  dma_pool_init() may be called again on the same pool (say on
+ * "usb reset"): the store is reused and every block returns to the
+ * free list.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <dma_pool.h>
+#include <asm/addrspace.h>
+
+/* lines are 16 bytes on the 4Kc and 32 on the 24K */
+#define DMA_POOL_ALIGN		32
+
+static struct dma_pool *dma_pools = NULL;
+
+int dma_pool_init (struct dma_pool *pool, const char *name, size_t size, int count)
+{
+	ulong total, i;
+	uchar *p;
+	void **link;
+
+	size = (size + DMA_POOL_ALIGN - 1) & ~(DMA_POOL_ALIGN - 1);
+	if (pool->mem && (pool->size != size || pool->count != count)) {
+		free(pool->mem);
+		pool->mem = NULL;
+	}
+	if (pool->mem == NULL) {
+		total = size * count + DMA_POOL_ALIGN;
+		if ((pool->mem = malloc(total)) == NULL) {
+			printf("dma_pool %s: can't allocate %lu bytes\n", name, total);
+			return -1;
+		}
+		flush_dcache_range((ulong)pool->mem, (ulong)pool->mem + total);
+	}
+	if (pool->name == NULL) {
+		pool->next = dma_pools;
+		dma_pools = pool;
+	}
+	pool->name = name;
+	pool->size = size;
+	pool->count = count;
+	pool->in_use = pool->peak = pool->allocs = pool->fails = 0;
+
+	/* chain the blocks, lowest address first */
+	p = (uchar *)KSEG1ADDR(((ulong)pool->mem + DMA_POOL_ALIGN - 1) & ~(DMA_POOL_ALIGN - 1));
+	pool->free = NULL;
+	link = &pool->free;
+	for (i = 0; i < count; i++, p += size) {
+		*link = p;
+		link = (void **)p;
+	}
+	*link = NULL;
+	return 0;
+}
+
+/*
+ * Returns a zeroed block, or NULL when the pool is exhausted.
+ */
+void *dma_pool_alloc (struct dma_pool *pool)
+{
+	void *p = pool->free;
+
+	if (p == NULL) {
+		pool->fails++;
+		return NULL;
+	}
+	pool->free = *(void **)p;
+	memset(p, 0, pool->size);
+
+	pool->allocs++;
+	if (++pool->in_use > pool->peak)
+		pool->peak = pool->in_use;
+	return p;
+}
+
+void dma_pool_free (struct dma_pool *pool, void *p)
+{
+	if (p == NULL)
+		return;
+	*(void **)p = pool->free;
+	pool->free = p;
+	pool->in_use--;
+}
+
+#ifdef RT2880_U_BOOT_CMD_OPEN
+int do_dmapool (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	struct dma_pool *pool;
+
+	printf("%-12s %6s %6s %6s %6s %8s %6s\n",
+		"pool", "size", "count", "used", "peak", "allocs", "fails");
+	for (pool = dma_pools; pool; pool = pool->next)
+		printf("%-12s %6lu %6lu %6lu %6lu %8lu %6lu\n", pool->name,
+			pool->size, pool->count, pool->in_use, pool->peak,
+			pool->allocs, pool->fails);
+	return 0;
+}
+
+U_BOOT_CMD(
+	dmapool,	1,	1,	do_dmapool,
+	"dmapool - show DMA pool usage\n",
+	"\n    - list block size, depth, use and failures of every DMA pool\n"
+);
+#endif /* RT2880_U_BOOT_CMD_OPEN */
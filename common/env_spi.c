@@ -80,53 +80,18 @@ int spi_env_init(void)
 
 int saveenv(void)
 {
-	int	len, rc;
-	ulong	flash_sect_addr;
-#if defined(CFG_ENV_SECT_SIZE) && (CFG_ENV_SECT_SIZE > CFG_ENV_SIZE)
-	ulong	flash_offset;
-	uchar	env_buffer[CFG_ENV_SECT_SIZE];
-#else
-	uchar *env_buffer = (char *)env_ptr;
-#endif	/* CFG_ENV_SECT_SIZE */
-	int rcode = 0;
-
-#if defined(CFG_ENV_SECT_SIZE) && (CFG_ENV_SECT_SIZE > CFG_ENV_SIZE)
-	flash_offset	= ((ulong)flash_addr) & (CFG_ENV_SECT_SIZE-1);
-	flash_sect_addr	= ((ulong)flash_addr) & ~(CFG_ENV_SECT_SIZE-1);
-	len	= CFG_ENV_SECT_SIZE;
-
 	/*
-	debug ( "copy old content: "
-		"sect_addr: %08lX  env_addr: %08lX  offset: %08lX\n",
-		flash_sect_addr, (ulong)flash_addr, flash_offset);
-	*/
-
-	/* copy old contents to temporary buffer */
-	if (raspi_read(env_buffer, flash_sect_addr, len) != len)
-		return 1;
-
-	/* copy current environment to temporary buffer */
-	memcpy ((uchar *)((unsigned long)env_buffer + flash_offset),
-		env_ptr, CFG_ENV_SIZE);
-#else
-	flash_sect_addr = (ulong)flash_addr;
-	len	= CFG_ENV_SIZE;
-#endif	/* CFG_ENV_SECT_SIZE */
-
-	puts ("Erasing SPI Flash...\n");
-	if (raspi_erase(flash_sect_addr, len))
-		return 1;
-
+	 * raspi_erase_write() reads the sector back and only erases and
+	 * programs the erase units the environment actually changes.
+	 */
 	puts ("Writing to SPI Flash...\n");
-	rc = raspi_write(env_buffer, flash_sect_addr, len);
-	if (rc != len) {
-		printf ("error %d!\n", rc);
-		rcode = 1;
-	} else {
-		puts ("done\n");
+	if (raspi_erase_write((char *)env_ptr, (unsigned int)flash_addr, CFG_ENV_SIZE) != 0) {
+		puts ("error!\n");
+		return 1;
 	}
+	puts ("done\n");
 
-	return rcode;
+	return 0;
 }
 
 #endif /* CMD_SAVEENV */
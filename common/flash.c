@@ -161,6 +161,10 @@ flash_write (uchar *src, ulong addr, ulong cnt)
 		return (ERR_INVAL);
 	}
 
+	if (flash_gen_bump(addr, cnt) != 0) {
+		return (ERR_PROG_ERROR);
+	}
+
 	for (info = info_first; info <= info_last; ++info) {
 		ulong b_end = info->start[0] + info->size;	/* bank end addr */
 		short s_end = info->sector_count - 1;
@@ -194,6 +198,61 @@ flash_write (uchar *src, ulong addr, ulong cnt)
 #endif /* CONFIG_SPD823TS */
 }
 
+#ifndef CONFIG_SPD823TS
+static int flash_is_blank (uchar *p, ulong len)
+{
+	while (len--)
+		if (*p++ != 0xff)
+			return (0);
+	return (1);
+}
+
+/*-----------------------------------------------------------------------
+ * Erase what is needed and copy memory to flash.
+ * A sector that already holds the data is skipped, and one whose
+ * target range is still erased is programmed without erasing it.
+ * Erases are whole sectors, as with flash_sect_erase().
+ * Returns the flash_write() codes.
+ */
+int
+flash_erase_write (uchar *src, ulong addr, ulong cnt)
+{
+	flash_info_t *info;
+	ulong end, len;
+	int s, rc, total = 0, same = 0, noerase = 0;
+
+	while (cnt > 0) {
+		if ((info = addr2info (addr)) == NULL)
+			return (ERR_INVAL);
+		for (s = info->sector_count - 1; s > 0 && info->start[s] > addr; --s)
+			;
+		end = (s == info->sector_count - 1) ?
+			info->start[0] + info->size : info->start[s + 1];
+		len = end - addr;
+		if (len > cnt)
+			len = cnt;
+
+		++total;
+		if (memcmp ((void *)addr, src, len) == 0) {
+			++same;
+		} else {
+			if (flash_is_blank ((uchar *)addr, len))
+				++noerase;
+			else if ((rc = flash_erase (info, s, s)) != 0)
+				return (rc);
+			if ((rc = flash_write (src, addr, len)) != 0)
+				return (rc);
+		}
+		src  += len;
+		addr += len;
+		cnt  -= len;
+	}
+	printf ("%d sectors: %d unchanged, %d written without erase\n",
+		total, same, noerase);
+	return (ERR_OK);
+}
+#endif /* CONFIG_SPD823TS */
+
 /*-----------------------------------------------------------------------
  */
 
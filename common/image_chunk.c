@@ -0,0 +1,215 @@
+/*
+ * Chunked image loading
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * A chunked image (see chunk_index_t in image.h) is read from flash one
+ * chunk at a time into a bounce buffer the size of the largest chunk,
+ * checked against the CRC in the index and decoded straight to its place
+ * at the load address.  Nothing is staged at CFG_SPINAND_LOAD_ADDR and
+ * no full-image CRC pass is needed.  The chunk CRCs are checked even
+ * when "verify" is off or the image has a valid "vfy_*" record: a bad
+ * chunk would otherwise go to a decoder that trusts its input.
+ */
+
+#include <common.h>
+#include <image.h>
+#include <malloc.h>
+#include <bzlib.h>
+#include <LzmaDecode.h>
+#include <asm/byteorder.h>
+#if defined (CFG_ENV_IS_IN_NAND)
+#include <nand_api.h>
+#elif defined (CFG_ENV_IS_IN_SPI)
+#include <spi_api.h>
+#endif
+
+extern int gunzip (void *, int, unsigned char *, unsigned long *);
+
+/*
+ * Return a pointer to 'len' bytes of image data at 'addr'; flash that
+ * is not memory mapped is read into 'buf' first.
+ */
+static uchar *chunk_map(ulong addr, ulong len, uchar *buf)
+{
+#if defined (CFG_ENV_IS_IN_NAND)
+	if (addr >= CFG_FLASH_BASE) {
+		ranand_read((char *)buf, addr - CFG_FLASH_BASE, len);
+		return buf;
+	}
+#elif defined (CFG_ENV_IS_IN_SPI)
+	if (addr >= CFG_FLASH_BASE) {
+		raspi_read((char *)buf, addr - CFG_FLASH_BASE, len);
+		return buf;
+	}
+#endif
+	return (uchar *)addr;
+}
+
+static int chunk_is_mapped(ulong addr)
+{
+#if defined (CFG_ENV_IS_IN_NAND) || defined (CFG_ENV_IS_IN_SPI)
+	return (addr < CFG_FLASH_BASE);
+#else
+	return 1;
+#endif
+}
+
+static int chunk_decode(int comp, uchar *dst, ulong dlen, uchar *src, ulong slen)
+{
+	ulong len = slen;
+
+	switch (comp) {
+	case IH_COMP_NONE:
+		if (slen != dlen)
+			return -1;
+		memmove(dst, src, slen);
+		return 0;
+	case IH_COMP_GZIP:
+		if (gunzip(dst, dlen, src, &len) != 0)
+			return -1;
+		break;
+#ifdef CONFIG_BZIP2
+	case IH_COMP_BZIP2:
+		{
+			unsigned int ulen = dlen;
+
+			if (BZ2_bzBuffToBuffDecompress((char *)dst, &ulen,
+					(char *)src, slen,
+					CFG_MALLOC_LEN < (4096 * 1024), 0) != BZ_OK)
+				return -1;
+			len = ulen;
+		}
+		break;
+#endif /* CONFIG_BZIP2 */
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA:
+		{
+			int ulen = dlen;
+
+			if (lzmaBuffToBuffDecompress((char *)dst, &ulen,
+					(char *)src, slen) != LZMA_RESULT_OK)
+				return -1;
+			len = ulen;
+		}
+		break;
+#endif /* CONFIG_LZMA */
+	default:
+		printf ("Unimplemented compression type %d\n", comp);
+		return -1;
+	}
+
+	return (len == dlen) ? 0 : -1;
+}
+
+/*
+ * Load the chunked image whose header 'hdr' was read from 'addr'.
+ * On success the uncompressed size is returned in '*lenp'.  A failure
+ * after the first chunk has been decoded leaves the load area trashed.
+ */
+int chunked_image_load(ulong addr, image_header_t *hdr, ulong *lenp)
+{
+	chunk_index_t ci, *idx;
+	chunk_entry_t *e;
+	ulong data = addr + sizeof(image_header_t);
+	uchar *dst = (uchar *)ntohl(hdr->ih_load);
+	int comp = hdr->ih_comp & ~IH_COMP_CHUNKED;
+	ulong n, i, isize, csize, size, left, max, checksum, dsize;
+	uchar *buf = NULL, *src;
+	int ret = 1;
+
+	memmove(&ci, chunk_map(data, sizeof(ci), (uchar *)&ci), sizeof(ci));
+	if (ntohl(ci.ci_magic) != IH_CHUNK_MAGIC) {
+		puts ("Bad Chunk Index Magic\n");
+		return 1;
+	}
+
+	n = ntohl(ci.ci_count);
+	dsize = ntohl(hdr->ih_size);
+	if (n == 0 || dsize < sizeof(chunk_index_t) ||
+	    n > (dsize - sizeof(chunk_index_t)) / sizeof(chunk_entry_t)) {
+		puts ("Bad Chunk Index Size\n");
+		return 1;
+	}
+	isize = sizeof(chunk_index_t) + n * sizeof(chunk_entry_t);
+	if ((idx = malloc(isize)) == NULL) {
+		puts ("Can't allocate chunk index\n");
+		return 1;
+	}
+	memmove(idx, chunk_map(data, isize, (uchar *)idx), isize);
+
+	checksum = ntohl(idx->ci_crc);
+	idx->ci_crc = 0;
+	if (crc32 (0, (char *)idx, isize) != checksum) {
+		puts ("Bad Chunk Index Checksum\n");
+		goto out;
+	}
+
+	csize = ntohl(idx->ci_chunk_size);
+	size = ntohl(idx->ci_size);
+	if (csize == 0 || size / csize + (size % csize != 0) != n) {
+		puts ("Bad Chunk Index Size\n");
+		goto out;
+	}
+	max = 0;
+	for (i = 0, e = idx->ci_entry; i < n; i++, e++) {
+		ulong offs = ntohl(e->ce_offset), clen = ntohl(e->ce_len);
+
+		/* every chunk lies within the image data */
+		if (offs > dsize || clen > dsize - offs) {
+			printf ("Bad Chunk Entry %lu\n", i);
+			goto out;
+		}
+		if (clen > max)
+			max = clen;
+	}
+	if (!chunk_is_mapped(data) && (buf = malloc(max)) == NULL) {
+		puts ("Can't allocate chunk buffer\n");
+		goto out;
+	}
+
+	printf ("   Loading %lu chunks of %lu kB ... ", n, csize >> 10);
+	left = size;
+	for (i = 0, e = idx->ci_entry; i < n; i++, e++) {
+		ulong clen = ntohl(e->ce_len);
+		ulong ulen = (left > csize) ? csize : left;
+
+		src = chunk_map(data + ntohl(e->ce_offset), clen, buf);
+		if (crc32 (0, (char *)src, clen) != ntohl(e->ce_crc)) {
+			printf ("Bad Data CRC in chunk %lu\n", i);
+			goto out;
+		}
+		if (chunk_decode(comp, dst, ulen, src, clen) != 0) {
+			printf ("Bad data in chunk %lu\n", i);
+			goto out;
+		}
+		dst += ulen;
+		left -= ulen;
+	}
+
+	*lenp = size;
+	ret = 0;
+out:
+	if (buf)
+		free(buf);
+	free(idx);
+	return ret;
+}
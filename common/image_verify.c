@@ -0,0 +1,222 @@
+/*
+ * Verified-image records
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Every successful full-data CRC of an image stored in flash leaves a
+ * record in the environment:
+ *
+ *	vfy_<flash offset>=<header crc>,<data size>,<write generation>
+ *
+ * "flash_gen" is bumped (once per boot, before the first write) whenever
+ * anything outside the environment sector is erased or programmed, so a
+ * record is only trusted while nothing has touched the flash since it
+ * was made.  A write whose bump cannot be saved fails.
+ *
+ * Trusting a record writes nothing, so a boot that changes no flash
+ * leaves the environment alone.  To still catch data that rots in
+ * place, one trusted boot in N on average checks the data again; a
+ * scrub that passes finds the record unchanged and does not save it.
+ *
+ * Knobs:
+ *	verify=full	always do the full-data CRC, ignore the records
+ *	vfy_scrub=N	re-check the data anyway on one boot in N
+ *			(default 16, 0 disables scrubbing)
+ */
+
+#include <common.h>
+#include <image.h>
+#if defined (CFG_ENV_IS_IN_FLASH)
+#include <flash.h>
+#endif
+
+#define VFY_SCRUB_DEFAULT	16
+#define VFY_SEEN		4
+
+/* set once flash_gen has been bumped and no record has been made since */
+static int flash_gen_bumped = 0;
+
+/*
+ * Images already accepted this boot: checking one again (bootm after
+ * check_image_validation) must not count down its record twice.
+ */
+static ulong vfy_seen[VFY_SEEN];
+static int vfy_nseen = 0;
+
+static int vfy_was_seen(ulong addr)
+{
+	int i;
+
+	for (i = 0; i < vfy_nseen; i++)
+		if (vfy_seen[i] == addr)
+			return 1;
+	return 0;
+}
+
+static void vfy_see(ulong addr)
+{
+	if (!vfy_was_seen(addr) && vfy_nseen < VFY_SEEN)
+		vfy_seen[vfy_nseen++] = addr;
+}
+
+static ulong vfy_scrub_period(void)
+{
+	char *s = getenv("vfy_scrub");
+
+	return s ? simple_strtoul(s, NULL, 10) : VFY_SCRUB_DEFAULT;
+}
+
+static int addr_in_flash(ulong addr)
+{
+#if defined (CFG_ENV_IS_IN_NAND) || defined (CFG_ENV_IS_IN_SPI)
+	return (addr >= CFG_FLASH_BASE);
+#else
+	return (addr2info(addr) != NULL);
+#endif
+}
+
+static ulong flash_gen_get(void)
+{
+	char *s = getenv("flash_gen");
+
+	return s ? simple_strtoul(s, NULL, 16) : 0;
+}
+
+static void vfy_name(char *buf, ulong addr)
+{
+	sprintf(buf, "vfy_%lx", addr - CFG_FLASH_BASE);
+}
+
+static void vfy_store(ulong addr, ulong hcrc, ulong size)
+{
+	char name[16], val[40];
+	char *s;
+
+	vfy_name(name, addr);
+	sprintf(val, "%lx,%lx,%lx", hcrc, size, flash_gen_get());
+
+	s = getenv(name);
+	if (s && strcmp(s, val) == 0)
+		return;
+	setenv(name, val);
+	saveenv();
+}
+
+/*
+ * Whether this boot scrubs the image at 'addr'.  Nothing counts boots
+ * without writing flash, so the draw comes from the CPU cycle count,
+ * which by the time an image is checked has picked up the jitter of
+ * the console, PHY and flash waits before it.
+ */
+static int vfy_scrub_due(ulong addr, ulong scrub)
+{
+	ulong x = get_timer(0) ^ addr;
+
+	x ^= x >> 16;
+	x *= 0x45d9f3b;
+	x ^= x >> 16;
+	return (x % scrub) == 0;
+}
+
+/*
+ * Returns 1 if the image whose header is at flash address 'addr' was
+ * fully verified before and nothing has been written to flash since,
+ * so that the caller may skip the data CRC.
+ */
+int image_verify_cached(ulong addr, ulong hcrc, ulong size)
+{
+	char name[16];
+	char *s;
+	ulong scrub;
+
+	if (!addr_in_flash(addr))
+		return 0;
+
+	s = getenv("verify");
+	if (s && strcmp(s, "full") == 0)
+		return 0;
+
+	vfy_name(name, addr);
+	if ((s = getenv(name)) == NULL)
+		return 0;
+	if (simple_strtoul(s, &s, 16) != hcrc || *s++ != ',')
+		return 0;
+	if (simple_strtoul(s, &s, 16) != size || *s++ != ',')
+		return 0;
+	if (simple_strtoul(s, &s, 16) != flash_gen_get())
+		return 0;
+	if (vfy_was_seen(addr))
+		return 1;
+
+	scrub = vfy_scrub_period();
+	if (scrub && vfy_scrub_due(addr, scrub)) {
+		puts("   Scrubbing cached image ...\n");
+		return 0;
+	}
+
+	vfy_see(addr);
+	return 1;
+}
+
+/*
+ * Remember that the image at 'addr' passed a full-data CRC.
+ * The environment is only saved when the record actually changes.
+ */
+void image_verify_record(ulong addr, ulong hcrc, ulong size)
+{
+	if (!addr_in_flash(addr))
+		return;
+
+	flash_gen_bumped = 0;
+	vfy_store(addr, hcrc, size);
+	vfy_see(addr);
+}
+
+/*
+ * Called by the flash drivers before they erase or program the range
+ * [addr, addr + len).  Writes to the environment sector itself do not
+ * invalidate anything.  Returns non-zero if the new generation could
+ * not be saved: the caller must then leave the flash alone, or the
+ * records would still be trusted after the next reset.  The records
+ * are stale in RAM either way.
+ */
+int flash_gen_bump(ulong addr, ulong len)
+{
+	DECLARE_GLOBAL_DATA_PTR;
+	char val[12];
+
+	if (flash_gen_bumped || !(gd->flags & GD_FLG_DEVINIT))
+		return 0;
+	if (addr >= CFG_ENV_ADDR && addr + len <= CFG_ENV_ADDR + CFG_ENV_SECT_SIZE)
+		return 0;
+
+	/* set first: saveenv() below comes back here for the env sector */
+	flash_gen_bumped = 1;
+	vfy_nseen = 0;
+	sprintf(val, "%lx", flash_gen_get() + 1);
+	setenv("flash_gen", val);
+	if (saveenv() != 0) {
+		printf("Can't save flash_gen, flash left unchanged\n");
+		flash_gen_bumped = 0;
+		return -1;
+	}
+	return 0;
+}
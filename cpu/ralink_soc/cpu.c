@@ -24,6 +24,7 @@
 #include <common.h>
 #include <command.h>
 #include <asm/mipsregs.h>
+#include <asm/cacheops.h>
 #include <rt_mmap.h>
 
 #define SOFTRES_REG (RALINK_SYSCTL_BASE + 0x0034)
@@ -38,6 +39,30 @@ void flush_cache (ulong start_addr, ulong size)
 {
 
 }
+
+#define cache_op(op, addr)	\
+	__asm__ __volatile__("cache	%0, 0(%1)" : : "i" (op), "r" (addr))
+
+/*
+ * Write back and invalidate, or just invalidate, the D-cache lines
+ * covering [start, stop).  Lines are stepped at the smallest line size
+ * of the supported cores, so partial lines at either end are included.
+ */
+void flush_dcache_range (ulong start, ulong stop)
+{
+	ulong a;
+
+	for (a = start & ~(CFG_CACHELINE_SIZE - 1); a < stop; a += CFG_CACHELINE_SIZE)
+		cache_op(Hit_Writeback_Inv_D, a);
+}
+
+void invalidate_dcache_range (ulong start, ulong stop)
+{
+	ulong a;
+
+	for (a = start & ~(CFG_CACHELINE_SIZE - 1); a < stop; a += CFG_CACHELINE_SIZE)
+		cache_op(Hit_Invalidate_D, a);
+}
 #ifdef RT2880_U_BOOT_CMD_OPEN
 
 void write_one_tlb( int index, u32 pagemask, u32 hi, u32 low0, u32 low1 ){
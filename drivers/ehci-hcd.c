@@ -32,6 +32,7 @@
 #include <usb.h>
 #include <asm/io.h>
 #include <malloc.h>
+#include <dma_pool.h>
 
 #include "ehci.h"
 
@@ -45,8 +46,15 @@ volatile struct ehci_hcor *hcor;
 uint16_t portreset;
 struct QH qh_list_global __attribute__((aligned(32)));
 struct QH *qh_list = NULL;
-struct QH alloc_qh __attribute__((aligned(32)));
-struct qTD alloc_td[3] __attribute__((aligned (32)));
+
+/* one QH and up to CFG_EHCI_QTD_NUM qTDs per transfer */
+#ifndef CFG_EHCI_QTD_NUM
+#define CFG_EHCI_QTD_NUM	3
+#endif
+static struct dma_pool ehci_qh_pool, ehci_qtd_pool;
+static struct QH *cur_qh;
+static struct qTD *cur_td[CFG_EHCI_QTD_NUM];
+static int cur_ntds;
 
 struct descriptor {
 	struct usb_hub_descriptor hub;
@@ -229,6 +237,20 @@ static int handshake(uint32_t *ptr, uint32_t mask, uint32_t done, int usec)
 
 static void ehci_free(void *p, size_t sz)
 {
+	int i;
+
+	if (p == cur_qh) {
+		dma_pool_free(&ehci_qh_pool, p);
+		cur_qh = NULL;
+		return;
+	}
+	for (i = 0; i < cur_ntds; i++) {
+		if (cur_td[i] == p) {
+			dma_pool_free(&ehci_qtd_pool, p);
+			cur_td[i] = cur_td[--cur_ntds];
+			return;
+		}
+	}
 }
 
 static int ehci_reset(void)
@@ -266,33 +288,34 @@ static void rt_sync_buf_to_cpu(void *buf, size_t sz)
 	memcpy(buf, buf_noncache, sz);
 }
 
+/*
+ * Blocks come from uncached pools.  A new QH starts a new transfer, so
+ * whatever the previous one still holds goes back to the pools first.
+ */
 static void *ehci_alloc(size_t sz, size_t align, int td_num)
 {
-//	static struct QH qh __attribute__((aligned(32)));
-//	static struct qTD td[3] __attribute__((aligned (32)));
-	static int ntds=0;
 	void *p;
 
 	switch (sz) {
 	case sizeof(struct QH):
-		p = &alloc_qh;
-		ntds = 0;
+		while (cur_ntds > 0)
+			ehci_free(cur_td[cur_ntds - 1], sizeof(struct qTD));
+		if (cur_qh)
+			ehci_free(cur_qh, sizeof(struct QH));
+		p = cur_qh = dma_pool_alloc(&ehci_qh_pool);
 		break;
 	case sizeof(struct qTD):
-		if (ntds == 3) {
+		if ((p = dma_pool_alloc(&ehci_qtd_pool)) == NULL) {
 			debug("out of TDs\n");
 			return NULL;
 		}
-		p = &alloc_td[ntds];
-		ntds++;
+		cur_td[cur_ntds++] = p;
 		break;
 	default:
 		debug("unknown allocation size\n");
 		return NULL;
 	}
 
-	p = KSEG1ADDR(p);
-	memset(p, sz, 0);
 	return p;
 }
 
@@ -543,12 +566,9 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 	return (dev->status != USB_ST_NOT_PROC) ? 0 : -1;
 
 fail:
-	td = (void *)hc32_to_cpu(qh->qh_overlay.qt_next);
-	while (td != (void *)QT_NEXT_TERMINATE) {
-		qh->qh_overlay.qt_next = td->qt_next;
-		ehci_free(td, sizeof(*td));
-		td = (void *)hc32_to_cpu(qh->qh_overlay.qt_next);
-	}
+	/* qt_next holds bus addresses, so release what this transfer took */
+	while (cur_ntds > 0)
+		ehci_free(cur_td[cur_ntds - 1], sizeof(struct qTD));
 	ehci_free(qh, sizeof(*qh));
 	return -1;
 }
@@ -860,6 +880,12 @@ int usb_lowlevel_init(void)
 #endif
 	qh_list = KSEG1ADDR(&qh_list_global);
 
+	cur_qh = NULL;
+	cur_ntds = 0;
+	if (dma_pool_init(&ehci_qh_pool, "ehci_qh", sizeof(struct QH), 1) != 0 ||
+	    dma_pool_init(&ehci_qtd_pool, "ehci_qtd", sizeof(struct qTD), CFG_EHCI_QTD_NUM) != 0)
+		return -1;
+
 	/* Set head of reclaim list */
 	memset(qh_list, 0, sizeof(struct QH));
 	qh_list->qh_link = EHCI_virt_to_bus(cpu_to_hc32((uint32_t)qh_list | QH_LINK_TYPE_QH));
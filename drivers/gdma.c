@@ -0,0 +1,298 @@
+/*
+ * Memory to memory copies and fills on the Generic DMA engine
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * dma_memcpy() and dma_memset() behave like memcpy() and memset().  The
+ * CPU does the head up to the first cache line boundary of the
+ * destination and the tail, GDMA the line aligned middle in transfers of
+ * at most GDMA_MAX_XFER bytes.  Source lines are written back and
+ * destination lines invalidated beforehand, so the CPU must not touch
+ * the destination until the call returns.
+ *
+ * Short, overlapping or not co-aligned requests, and SoCs whose GDMA
+ * block is not the 8 channel one handled here, simply use the CPU.
+ *
+ * dma_dev_read() and dma_dev_wait() drain a peripheral FIFO paced by
+ * its DMA request line, dma_dev_read_split() into two places through a
+ * second, chained channel; they fail on SoCs without the engine and the
+ * caller reads the FIFO itself.
+ */
+
+#include <common.h>
+#include <rt_mmap.h>
+#include <gdma_api.h>
+#include <asm/addrspace.h>
+
+#if defined (RT3052_ASIC_BOARD) || defined (RT3052_FPGA_BOARD) || \
+    defined (RT2883_ASIC_BOARD) || defined (RT2883_FPGA_BOARD)
+#define GDMA_MEM_COPY
+#endif
+
+#ifdef GDMA_MEM_COPY
+
+#define GDMA_CHNUM		7	/* channel 0 belongs to stage1 NAND */
+#define GDMA_DEV_CHNUM		0	/* free again once stage2 runs */
+#define GDMA_TAIL_CHNUM		1	/* second half of a split read */
+
+#define GDMA_SRC_REG(ch)	(RALINK_GDMA_BASE + (ch) * 16)
+#define GDMA_DST_REG(ch)	(GDMA_SRC_REG(ch) + 4)
+#define GDMA_CTRL_REG(ch)	(GDMA_SRC_REG(ch) + 8)
+#define GDMA_CTRL_REG1(ch)	(GDMA_SRC_REG(ch) + 12)
+#define GDMA_ISTS_REG		(RALINK_GDMA_BASE + 0x80)	/* done, write 1 to clear */
+
+/* Control Reg */
+#define MODE_SEL_SOFT		(1 << 0)
+#define CH_EBL			(1 << 1)
+#define BRST_SIZE_16W		(4 << 3)
+#define DST_BRST_FIX		(1 << 6)
+#define SRC_BRST_FIX		(1 << 7)
+#define DST_DMA_REQ_MEM		(8 << 8)
+#define SRC_DMA_REQ_MEM		(8 << 12)
+#define SRC_DMA_REQ(n)		((n) << 12)
+#define TRANS_CNT_OFFSET	16
+
+/* Control Reg1 */
+#define CH_MASK			(1 << 0)
+#define NEXT_UNMASK_CH_OFFSET	1
+
+#define GDMA_READ_REG(addr)		le32_to_cpu(*(volatile u32 *)(addr))
+#define GDMA_WRITE_REG(addr, val)	*((volatile u32 *)(addr)) = cpu_to_le32(val)
+
+/* 24K lines are 32 bytes, 4Kc ones 16: align to the larger */
+#define GDMA_LINE		32
+#define GDMA_MAX_XFER		(0x10000 - GDMA_LINE)	/* 16 bit count */
+
+extern unsigned long mips_cpu_feq;
+
+static int cached(ulong addr)
+{
+	return (addr >= KSEG0 && addr < KSEG1);
+}
+
+/* set by the first timeout: the CPU does everything from then on */
+static int gdma_off = 0;
+
+/*
+ * Wait for channel 'ch' to finish, as stage1 does: its done bit in
+ * GDMAISTS is polled and cleared, and CH_EBL is dropped by hand.  A
+ * channel still busy after 100 ms is stopped and GDMA left unused.
+ */
+static int gdma_wait(int ch)
+{
+	ulong tmo = (mips_cpu_feq / 2) / 10;
+	ulong start = get_timer(0);
+	int ret = 0;
+
+	while (!(GDMA_READ_REG(GDMA_ISTS_REG) & (1 << ch))) {
+		if (get_timer(start) > tmo) {
+			printf("%s: timeout, GDMA off\n", __func__);
+			gdma_off = 1;
+			ret = -1;
+			break;
+		}
+	}
+	GDMA_WRITE_REG(GDMA_CTRL_REG(ch),
+		GDMA_READ_REG(GDMA_CTRL_REG(ch)) & ~CH_EBL);
+	GDMA_WRITE_REG(GDMA_ISTS_REG, 1 << ch);
+	return ret;
+}
+
+/*
+ * Move 'len' bytes (line aligned at 'dst') and wait for it.  With
+ * 'fix_src' the word at 'src' is repeated.  Returns -1 on a timeout.
+ */
+static int gdma_xfer(ulong dst, ulong src, ulong len, int fix_src)
+{
+	ulong ctrl;
+
+	GDMA_WRITE_REG(GDMA_ISTS_REG, 1 << GDMA_CHNUM);
+	GDMA_WRITE_REG(GDMA_SRC_REG(GDMA_CHNUM), PHYSADDR(src));
+	GDMA_WRITE_REG(GDMA_DST_REG(GDMA_CHNUM), PHYSADDR(dst));
+	/* chain to itself, not masked: starts as soon as it is enabled */
+	GDMA_WRITE_REG(GDMA_CTRL_REG1(GDMA_CHNUM), GDMA_CHNUM << NEXT_UNMASK_CH_OFFSET);
+
+	ctrl = (len << TRANS_CNT_OFFSET) | SRC_DMA_REQ_MEM | DST_DMA_REQ_MEM |
+		BRST_SIZE_16W | MODE_SEL_SOFT | CH_EBL;
+	if (fix_src)
+		ctrl |= SRC_BRST_FIX;
+	GDMA_WRITE_REG(GDMA_CTRL_REG(GDMA_CHNUM), ctrl);
+
+	return gdma_wait(GDMA_CHNUM);
+}
+
+static void dma_region(ulong dst, ulong src, ulong len, int fix_src)
+{
+	ulong n;
+
+	if (cached(dst))
+		invalidate_dcache_range(dst, dst + len);
+	while (len > 0) {
+		n = (len > GDMA_MAX_XFER) ? GDMA_MAX_XFER : len;
+		if (gdma_xfer(dst, src, n, fix_src) != 0)
+			break;
+		dst += n;
+		if (!fix_src)
+			src += n;
+		len -= n;
+	}
+	if (len == 0)
+		return;
+
+	/* the engine hung, finish with the CPU */
+	if (fix_src)
+		memset((void *)dst, *(u8 *)src, len);
+	else
+		memcpy((void *)dst, (void *)src, len);
+}
+
+/* bytes before the first line boundary at or after 'addr' */
+static ulong head_len(ulong addr)
+{
+	return (GDMA_LINE - (addr & (GDMA_LINE - 1))) & (GDMA_LINE - 1);
+}
+
+void *dma_memcpy(void *dst, const void *src, size_t len)
+{
+	ulong d = (ulong)dst, s = (ulong)src;
+	ulong head, body;
+
+	if (gdma_off || len < GDMA_MIN_LEN || ((d ^ s) & 3) != 0 ||
+	    (d < s + len && s < d + len))
+		return memmove(dst, src, len);
+
+	head = head_len(d);
+	body = (len - head) & ~(GDMA_LINE - 1);
+	memcpy(dst, src, head);
+	if (cached(s))
+		flush_dcache_range(s + head, s + head + body);
+	dma_region(d + head, s + head, body, 0);
+	memcpy((void *)(d + head + body), (void *)(s + head + body),
+		len - head - body);
+	return dst;
+}
+
+void *dma_memset(void *dst, int c, size_t len)
+{
+	static u32 pattern;
+	ulong d = (ulong)dst;
+	ulong head, body;
+
+	if (gdma_off || len < GDMA_MIN_LEN)
+		return memset(dst, c, len);
+
+	pattern = (u8)c * 0x01010101;
+	flush_dcache_range((ulong)&pattern, (ulong)&pattern + sizeof(pattern));
+
+	head = head_len(d);
+	body = (len - head) & ~(GDMA_LINE - 1);
+	memset(dst, c, head);
+	dma_region(d + head, (ulong)&pattern, body, 1);
+	memset((void *)(d + head + body), c, len - head - body);
+	return dst;
+}
+
+/* set when dma_dev_wait() has a tail channel to wait for as well */
+static int gdma_dev_tail = 0;
+
+/* a 'masked' channel waits for the one chained to it to finish */
+static void gdma_dev_arm(int ch, int next, int masked, void *dst, ulong fifo,
+		int req, ulong len)
+{
+	GDMA_WRITE_REG(GDMA_ISTS_REG, 1 << ch);
+	GDMA_WRITE_REG(GDMA_SRC_REG(ch), PHYSADDR(fifo));
+	GDMA_WRITE_REG(GDMA_DST_REG(ch), PHYSADDR(dst));
+	GDMA_WRITE_REG(GDMA_CTRL_REG1(ch),
+		(next << NEXT_UNMASK_CH_OFFSET) | (masked ? CH_MASK : 0));
+	GDMA_WRITE_REG(GDMA_CTRL_REG(ch),
+		(len << TRANS_CNT_OFFSET) | SRC_DMA_REQ(req) | DST_DMA_REQ_MEM |
+		SRC_BRST_FIX | CH_EBL);
+}
+
+/*
+ * Arm a transfer of 'len' bytes (a multiple of 4, at most 64 kB) from
+ * the FIFO register 'fifo' to 'dst', one word per request of line 'req'.
+ * 'dst' must be word aligned and the caller owns its cache lines: they
+ * are to be invalidated beforehand and left alone until dma_dev_wait().
+ */
+int dma_dev_read(void *dst, ulong fifo, int req, ulong len)
+{
+	if (gdma_off || (len & 3) || len > GDMA_MAX_XFER || ((ulong)dst & 3))
+		return -1;
+
+	gdma_dev_tail = 0;
+	gdma_dev_arm(GDMA_DEV_CHNUM, GDMA_DEV_CHNUM, 0, dst, fifo, req, len);
+	return 0;
+}
+
+/* the same, with the last 'tail_len' bytes going to 'tail' */
+int dma_dev_read_split(void *dst, ulong len, void *tail, ulong tail_len,
+		ulong fifo, int req)
+{
+	if (gdma_off || (len & 3) || len > GDMA_MAX_XFER || ((ulong)dst & 3) ||
+	    (tail_len & 3) || tail_len > GDMA_MAX_XFER || ((ulong)tail & 3))
+		return -1;
+
+	gdma_dev_tail = 1;
+	gdma_dev_arm(GDMA_TAIL_CHNUM, GDMA_TAIL_CHNUM, 1, tail, fifo, req, tail_len);
+	gdma_dev_arm(GDMA_DEV_CHNUM, GDMA_TAIL_CHNUM, 0, dst, fifo, req, len);
+	return 0;
+}
+
+int dma_dev_wait(void)
+{
+	if (gdma_wait(GDMA_DEV_CHNUM) != 0) {
+		if (gdma_dev_tail)
+			GDMA_WRITE_REG(GDMA_CTRL_REG(GDMA_TAIL_CHNUM), 0);
+		return -1;
+	}
+	return gdma_dev_tail ? gdma_wait(GDMA_TAIL_CHNUM) : 0;
+}
+
+#else /* !GDMA_MEM_COPY */
+
+void *dma_memcpy(void *dst, const void *src, size_t len)
+{
+	return memmove(dst, src, len);
+}
+
+void *dma_memset(void *dst, int c, size_t len)
+{
+	return memset(dst, c, len);
+}
+
+int dma_dev_read(void *dst, ulong fifo, int req, ulong len)
+{
+	return -1;
+}
+
+int dma_dev_read_split(void *dst, ulong len, void *tail, ulong tail_len,
+		ulong fifo, int req)
+{
+	return -1;
+}
+
+int dma_dev_wait(void)
+{
+	return -1;
+}
+
+#endif /* GDMA_MEM_COPY */
@@ -2,11 +2,15 @@
 #include <command.h>
 #include <malloc.h>
 #include <configs/rt2880.h>
+#include <gdma_api.h>
 #include "ralink_nand.h"
 
 
+/* tools/nandsim supplies its own register accessors */
+#ifndef ra_inl
 #define ra_inl(addr)  (*(volatile u32 *)(addr))
 #define ra_outl(addr, value)  (*(volatile u32 *)(addr) = (value))
+#endif
 #define ra_and(addr, value) ra_outl(addr, (ra_inl(addr) & (value)))
 #define ra_or(addr, value) ra_outl(addr, (ra_inl(addr) | (value)))
 
@@ -20,6 +24,10 @@
 
 static int nfc_wait_ready(int snooze_ms);
 int nfc_read_page(char *buf, int page);
+#ifdef CONFIG_BADBLOCK_CHECK
+static int ranand_bbt_scan(void);
+static void ranand_bbt_mark(int page);
+#endif
 
 /**
  * reset nand chip
@@ -164,6 +172,9 @@ unsigned long ranand_init(void)
 
 	if (nfc_all_reset() != 0)
 		return -1;
+#ifdef CONFIG_BADBLOCK_CHECK
+	ranand_bbt_scan();	/* "nand bbt" lists what it found */
+#endif
 	return CFG_CHIPSIZE;
 }
 
@@ -226,7 +237,7 @@ static int _ra_nand_pull_data(char *buf, int len)
 #ifdef RW_DATA_BY_BYTE
 	return (int)(p - buf);
 #else
-	return ((int)p - (int)buf);
+	return ((char *)p - buf);
 #endif
 }
 
@@ -284,7 +295,7 @@ static int _ra_nand_push_data(char *buf, int len)
 #ifdef RW_DATA_BY_BYTE
 	return (int)(p - buf);
 #else
-	return ((int)p - (int)buf);
+	return ((char *)p - buf);
 #endif
 }
 
@@ -428,6 +439,94 @@ static inline int nfc_write_raw_data(int cmd1, int cmd3, int bus_addr, int conf,
 	return 0;
 }
 
+/*
+ * Page reads come in by GDMA as one NFC transaction of data and OOB, so
+ * the controller's ECC covers the page and is checked as on PIO.  The
+ * data lands straight in a line aligned caller buffer, with the OOB
+ * split off into nfc_oob_buf, or else in a bounce buffer.
+ *
+ * Stage1 keeps each GDMA read to 60 bytes (WORK_AROUND_RXB_OV) because
+ * longer ones can overrun the controller's rx buffer; here an overrun
+ * shows up as an rx error in NFC_INT_ST, a stuck transfer or an ECC
+ * mismatch, and the first rx error or stuck transfer resets the
+ * controller and leaves every later read to PIO.
+ */
+#define NFC_CONF_GDMA		(1 << 2)
+#define NFC_DMA_LINE		32
+#define NFC_DMA_BUFSIZE		((CFG_PAGESIZE + CFG_PAGE_OOBSIZE + 31) & ~31)
+#define NFC_RX_ERR		(INT_ST_RX_TRAS_ERR | INT_ST_RX_KICK_ERR)
+
+static u32 nfc_dma_buf[2][NFC_DMA_BUFSIZE / 4] __attribute__ ((aligned (32)));
+static u32 nfc_oob_buf[2][NFC_DMA_LINE / 4] __attribute__ ((aligned (32)));
+static int nfc_use_dma = 1;
+
+/*
+ * Start a read of 'len' bytes to 'dst', or of 'len' bytes to 'dst' and
+ * the OOB after them to 'oob'.  Both are line aligned, and so is the
+ * end of 'dst' or the buffer is padded up to it.
+ */
+static int nfc_dma_start(int cmd1, int bus_addr, int conf, char *dst, int len, char *oob)
+{
+	ulong d = (ulong)dst;
+	int ret;
+
+	if (!nfc_use_dma)
+		return NAND_STATUS_FAIL;
+
+	invalidate_dcache_range(d, d + ((len + NFC_DMA_LINE - 1) & ~(NFC_DMA_LINE - 1)));
+	if (oob) {
+		invalidate_dcache_range((ulong)oob, (ulong)oob + NFC_DMA_LINE);
+		ret = dma_dev_read_split(dst, len, oob, CFG_PAGE_OOBSIZE,
+				NFC_DATA, GDMA_REQ_NAND);
+	}
+	else
+		ret = dma_dev_read(dst, NFC_DATA, GDMA_REQ_NAND, (len + 3) & ~3);
+	if (ret != 0) {
+		nfc_use_dma = 0;
+		return NAND_STATUS_FAIL;
+	}
+
+	CLEAR_INT_STATUS();
+	ra_outl(NFC_CMD1, cmd1);
+	ra_outl(NFC_ADDR, bus_addr);
+	ra_outl(NFC_CONF, conf | NFC_CONF_GDMA);
+	return 0;
+}
+
+static int nfc_dma_finish(void)
+{
+	int ret;
+
+	if (dma_dev_wait() != 0) {
+		printf("%s: gdma stuck, back to pio\n", __func__);
+		goto off;
+	}
+	if (ra_inl(NFC_INT_ST) & NFC_RX_ERR) {
+		printf("%s: rx overrun, back to pio\n", __func__);
+		goto off;
+	}
+	ret = nfc_wait_ready(0);
+	if (ret & NAND_STATUS_FAIL)
+		return NAND_STATUS_FAIL;
+	return 0;
+
+off:
+	nfc_use_dma = 0;
+	nfc_all_reset();
+	return NAND_STATUS_FAIL;
+}
+
+static int nfc_read_dma_data(int cmd1, int bus_addr, int conf, char *buf, int len)
+{
+	if (len > NFC_DMA_BUFSIZE ||
+	    nfc_dma_start(cmd1, bus_addr, conf, (char *)nfc_dma_buf[0], len, NULL) != 0 ||
+	    nfc_dma_finish() != 0)
+		return NAND_STATUS_FAIL;
+
+	memcpy(buf, nfc_dma_buf[0], len);
+	return 0;
+}
+
 /**
  * @return !0: fail
  * @return 0: OK
@@ -503,11 +602,44 @@ int nfc_write_oob(int page, unsigned int offs, char *buf, int len)
 	return 0;
 }
 
+/*
+ * ECC mismatches seen on reads per block since power-up, saturating;
+ * "nand ecc" shows them.  A read that fails its ECC is retried, and a
+ * block that keeps turning up here is due to be rewritten.  Nothing is
+ * corrected: the layout of the controller's code is not documented.
+ */
+static u8 nand_ecc_errs[CFG_NUMBLOCK];
+
+/*
+ * Compare the ECC the controller computed with the one stored in 'oob'.
+ * Any difference fails the page, be it in the data or in the stored ECC.
+ */
+static int nfc_ecc_compare(char *oob, int ecc, int page, int mode)
+{
+	u8 *s = (u8 *)oob + CONFIG_ECC_OFFSET;
+	u32 stored = s[0] | (s[1] << 8) | (s[2] << 16);
+	int block;
+
+	if (ecc == 0) //clean page.
+		return 0;
+	if (((stored ^ ecc) & 0xffffff) == 0)
+		return 0;
+
+	if (mode == FL_READING) {
+		block = (page >> CONFIG_NUMPAGE_PER_BLOCK_BIT) & (CFG_NUMBLOCK - 1);
+		if (nand_ecc_errs[block] < 0xff)
+			nand_ecc_errs[block]++;
+	}
+	printf("%s mode:%s, invalid ecc, page: %x read:%x %x %x, ecc:%x \n",
+			__func__, (mode == FL_READING)?"read":"write", page,
+			s[0], s[1], s[2], ecc);
+	return -1;
+}
+
 int nfc_ecc_verify(char *buf, int page, int mode)
 {
-	int ret, i;
-	char *p, *e;
-	int ecc;
+	int ret;
+	char *p;
 
 	//ra_dbg("%s, page:%x mode:%d\n", __func__, page, mode);
 
@@ -537,21 +669,7 @@ int nfc_ecc_verify(char *buf, int page, int mode)
 		return -2;
 
 ecc_check:
-	p += (1<<CONFIG_PAGE_SIZE_BIT);
-	ecc = ra_inl(NFC_ECC);
-	if (ecc == 0) //clean page.
-		return 0;
-	e = (char*)&ecc;
-	for (i=0; i<CONFIG_ECC_BYTES; i++) {
-		int eccpos = CONFIG_ECC_OFFSET + i;
-		if (*(p + eccpos) != *(e + i)) {
-			printf("%s mode:%s, invalid ecc, page: %x read:%x %x %x, ecc:%x \n",
-					__func__, (mode == FL_READING)?"read":"write", page,
-					*(p+ CONFIG_ECC_OFFSET), *(p+ CONFIG_ECC_OFFSET+1), *(p+ CONFIG_ECC_OFFSET +2), ecc);
-			return -1;
-		}
-	}
-	return 0;
+	return nfc_ecc_compare(p + (1<<CONFIG_PAGE_SIZE_BIT), ra_inl(NFC_ECC), page, mode);
 
 bad_block:
 	return -1;
@@ -592,7 +710,9 @@ int nfc_read_page(char *buf, int page)
 		conf |= (1<<3); 
 #endif
 
-		status = nfc_read_raw_data(cmd1, bus_addr, conf, buf+offs, len);
+		status = nfc_read_dma_data(cmd1, bus_addr, conf, buf+offs, len);
+		if (status & NAND_STATUS_FAIL)
+			status = nfc_read_raw_data(cmd1, bus_addr, conf, buf+offs, len);
 		if (status & NAND_STATUS_FAIL) {
 			printf("%s: fail \n", __func__);
 			return -1;
@@ -612,11 +732,121 @@ int nfc_read_page(char *buf, int page)
 	return 0;
 }
 
+/* PIO read of a page with the data to 'buf' and the OOB to 'oob', both word aligned */
+static int nfc_read_page_split(char *buf, char *oob, int page)
+{
+	int size = CFG_PAGESIZE + CFG_PAGE_OOBSIZE;
+	int conf = 0x000141| ((CFG_ADDR_CYCLE)<<16) | (size << 20) | (1<<3);
+
+	CLEAR_INT_STATUS();
+	ra_outl(NFC_CMD1, 0);
+	ra_outl(NFC_ADDR, page << (CFG_COLUMN_ADDR_CYCLE*8));
+	ra_outl(NFC_CONF, conf);
+
+	if (_ra_nand_pull_data(buf, CFG_PAGESIZE) != CFG_PAGESIZE ||
+	    _ra_nand_pull_data(oob, CFG_PAGE_OOBSIZE) != CFG_PAGE_OOBSIZE)
+		return NAND_STATUS_FAIL;
+	if (nfc_wait_ready(0) & NAND_STATUS_FAIL)
+		return NAND_STATUS_FAIL;
+	return 0;
+}
+
+/* start the GDMA read of 'page', to 'dst' directly or else to bounce buffer 'slot' */
+static int nfc_page_dma_start(char *dst, int page, int slot)
+{
+	int size = CFG_PAGESIZE + CFG_PAGE_OOBSIZE;
+	int conf = 0x000141| ((CFG_ADDR_CYCLE)<<16) | (size << 20) | (1<<3);
+	int bus_addr = page << (CFG_COLUMN_ADDR_CYCLE*8);
+
+	if (dst)
+		return nfc_dma_start(0, bus_addr, conf, dst, CFG_PAGESIZE,
+				(char *)nfc_oob_buf[slot]);
+	return nfc_dma_start(0, bus_addr, conf, (char *)nfc_dma_buf[slot], size, NULL);
+}
+
+/*
+ * Read the data of 'count' consecutive pages to 'buf', checking each
+ * page's ECC.  With GDMA the next page is already on its way while the
+ * CPU checks the ECC of the current one; a line aligned 'buf' takes the
+ * data directly, anything else goes through the two bounce buffers in
+ * turn.  Without GDMA 'buf' has to be word aligned and is read into
+ * directly.  Returns the number of pages read; anything left, e.g.
+ * after an ECC error, is for the caller to read one page at a time.
+ */
+static int nfc_read_pages(char *buf, int page, int count)
+{
+	int direct = ((ulong)buf & (NFC_DMA_LINE - 1)) == 0;
+	int i, ecc, next;
+	char *p, *oob;
+
+	if (count <= 0)
+		return 0;
+
+	if (nfc_use_dma) {
+		if (nfc_page_dma_start(direct ? buf : NULL, page, 0) != 0)
+			return 0;
+		for (i = 0; i < count; i++, buf += CFG_PAGESIZE) {
+			if (nfc_dma_finish() != 0)
+				return i;
+			/* latch this page's ECC before the next read resets it */
+			ecc = ra_inl(NFC_ECC);
+			next = (i + 1 < count) &&
+				nfc_page_dma_start(direct ? buf + CFG_PAGESIZE : NULL,
+					page + i + 1, (i + 1) & 1) == 0;
+
+			p = direct ? buf : (char *)nfc_dma_buf[i & 1];
+			oob = direct ? (char *)nfc_oob_buf[i & 1] : p + CFG_PAGESIZE;
+			if (nfc_ecc_compare(oob, ecc, page + i, FL_READING) != 0) {
+				if (next)
+					nfc_dma_finish();
+				return i;
+			}
+			if (!direct)
+				memcpy(buf, p, CFG_PAGESIZE);
+			if (!next)
+				return i + 1;
+		}
+		return count;
+	}
+
+	oob = (char *)nfc_oob_buf[0];
+	if ((ulong)buf & 3)
+		return 0;
+	for (i = 0; i < count; i++, buf += CFG_PAGESIZE)
+		if (nfc_read_page_split(buf, oob, page + i) != 0 ||
+		    nfc_ecc_compare(oob, ra_inl(NFC_ECC), page + i, FL_READING) != 0)
+			return i;
+	return count;
+}
+
+/*
+ * How much of what ranand_write() programs is read back and checked,
+ * from the environment variable "nand_verify":
+ *	full	every page
+ *	off	none, only the program status the chip reports
+ *	(unset)	the first page of each block and of each write
+ */
+#define NAND_VERIFY_OFF		0
+#define NAND_VERIFY_SAMPLE	1
+#define NAND_VERIFY_FULL	2
+
+static int nand_verify_policy(void)
+{
+	char *s = getenv("nand_verify");
+
+	if (s && strcmp(s, "full") == 0)
+		return NAND_VERIFY_FULL;
+	if (s && strcmp(s, "off") == 0)
+		return NAND_VERIFY_OFF;
+	return NAND_VERIFY_SAMPLE;
+}
+
 /** 
+ * @param verify: read the page back and check its ECC
  * @return -EIO, fail to write
  * @return 0, OK
  */
-int nfc_write_page(char *buf, int page)
+int nfc_write_page(char *buf, int page, int verify)
 {
 	unsigned int cmd1 = 0, cmd3, conf = 0;
 	unsigned int bus_addr = 0;
@@ -645,6 +875,9 @@ int nfc_write_page(char *buf, int page)
 		return -1;
 	}
 
+	if (!verify)
+		return 0;
+
 	status = nfc_ecc_verify(buf, page, FL_WRITING);
 	if (status != 0) {
 		printf("%s: ecc_verify fail: ret:%x \n", __func__, status);
@@ -652,6 +885,10 @@ int nfc_write_page(char *buf, int page)
 		page -= page % (CFG_BLOCKSIZE/CFG_PAGESIZE);
 		printf("create a bad block at page %x\n", page);
 		status = nfc_write_oob(page, CONFIG_BAD_BLOCK_POS, buf+CFG_PAGESIZE+CONFIG_BAD_BLOCK_POS, 1);
+#ifdef CONFIG_BADBLOCK_CHECK
+		/* bad from now on, even if the marker did not make it */
+		ranand_bbt_mark(page);
+#endif
 		if (status == 0)
 			printf("bad block acknowledged, please write again\n");
 		else
@@ -663,17 +900,59 @@ int nfc_write_page(char *buf, int page)
 }
 
 #ifdef CONFIG_BADBLOCK_CHECK
-int ranand_block_isbad(loff_t offs)
+#define BLOCK_SHIFT	(CONFIG_PAGE_SIZE_BIT + CONFIG_NUMPAGE_PER_BLOCK_BIT)
+
+/*
+ * One bit per block, set for bad ones.  ranand_bbt_scan() fills it from
+ * the markers once at init; until then ranand_block_isbad() reads OOB.
+ */
+static u8 nand_bbt[CFG_NUMBLOCK / 8];
+static int nand_bbt_valid = 0;
+
+static int nfc_page_isbad(int page)
 {
 	unsigned int tag;
-	int page, ret;
+	int ret;
 
-	page = offs >> CONFIG_PAGE_SIZE_BIT;
 	ret = nfc_read_oob(page, CONFIG_BAD_BLOCK_POS, (char*)&tag, 1);
 	if (ret == 0 && (tag & 0xff) == 0xff)
 		return 0;
 	return 1;
 }
+
+/* the factory marks a bad block in its first or second page */
+static int ranand_bbt_scan(void)
+{
+	int block, page, bad = 0;
+
+	nand_bbt_valid = 0;
+	memset(nand_bbt, 0, sizeof(nand_bbt));
+	for (block = 0; block < CFG_NUMBLOCK; block++) {
+		page = block << CONFIG_NUMPAGE_PER_BLOCK_BIT;
+		if (nfc_page_isbad(page) || nfc_page_isbad(page + 1)) {
+			nand_bbt[block >> 3] |= 1 << (block & 7);
+			bad++;
+		}
+	}
+	nand_bbt_valid = 1;
+	return bad;
+}
+
+static void ranand_bbt_mark(int page)
+{
+	int block = (page >> CONFIG_NUMPAGE_PER_BLOCK_BIT) & (CFG_NUMBLOCK - 1);
+
+	nand_bbt[block >> 3] |= 1 << (block & 7);
+}
+
+int ranand_block_isbad(loff_t offs)
+{
+	int block = (int)((offs & (CFG_CHIPSIZE - 1)) >> BLOCK_SHIFT);
+
+	if (!nand_bbt_valid)
+		return nfc_page_isbad((int)(offs >> CONFIG_PAGE_SIZE_BIT));
+	return (nand_bbt[block >> 3] >> (block & 7)) & 1;
+}
 #endif
 
 int ranand_erase(unsigned int offs, int len)
@@ -691,6 +970,9 @@ int ranand_erase(unsigned int offs, int len)
 		return -1;
 	}
 
+	if (flash_gen_bump(CFG_FLASH_BASE + offs, len) != 0)
+		return -1;
+
 	while (len) {
 		page = (int)(offs >> CONFIG_PAGE_SIZE_BIT);
 
@@ -733,6 +1015,7 @@ int ranand_write(char *buf, unsigned int to, int datalen)
 	int pagemask = (CFG_PAGESIZE -1);
 	loff_t addr = to;
 	char buffers[CFG_PAGESIZE + CFG_PAGE_OOBSIZE];
+	int policy = nand_verify_policy(), verify;
 
 #if 0
 	ops->retlen = 0;
@@ -744,6 +1027,8 @@ int ranand_write(char *buf, unsigned int to, int datalen)
 
 	if (buf == 0)
 		datalen = 0;
+	else if (flash_gen_bump(CFG_FLASH_BASE + to, datalen) != 0)
+		return -1;
 	
 #if 0
 	// oob sequential (burst) write
@@ -818,7 +1103,10 @@ int ranand_write(char *buf, unsigned int to, int datalen)
 			retlen += len;
 		}
 		
-		ret = nfc_write_page(buffers, page);
+		verify = (policy == NAND_VERIFY_FULL) ||
+			(policy == NAND_VERIFY_SAMPLE && (addr == to ||
+			 (page & ((1 << CONFIG_NUMPAGE_PER_BLOCK_BIT) - 1)) == 0));
+		ret = nfc_write_page(buffers, page, verify);
 		if (ret) {
 /*                        nand_bbt_set(ra, addr >> ra->erase_shift, BBT_TAG_BAD);*/
 			return -1;
@@ -863,6 +1151,22 @@ int ranand_read(char *buf, unsigned int from, int datalen)
 
 		if (datalen > (CFG_PAGESIZE+CFG_PAGE_OOBSIZE) && (page & 0x1f) == 0)
 			printf(".");
+
+		/* whole pages up to the end of the block skip the page buffer */
+		if ((addr & pagemask) == 0 && datalen >= CFG_PAGESIZE) {
+			int n = (1 << CONFIG_NUMPAGE_PER_BLOCK_BIT) -
+				(page & ((1 << CONFIG_NUMPAGE_PER_BLOCK_BIT) - 1));
+
+			n = nfc_read_pages(buf, page, min(n, datalen / CFG_PAGESIZE));
+			if (n > 0) {
+				buf += n * CFG_PAGESIZE;
+				datalen -= n * CFG_PAGESIZE;
+				retlen += n * CFG_PAGESIZE;
+				addr = (page + n) << CONFIG_PAGE_SIZE_BIT;
+				continue;
+			}
+		}
+
 		ret = nfc_read_page(buffers, page);
 		//FIXME, something strange here, some page needs 2 more tries to guarantee read success.
 		if (ret) {
@@ -923,11 +1227,17 @@ int ranand_read(char *buf, unsigned int from, int datalen)
 	return retlen;
 }
 
+/*
+ * Blocks that already hold the new data are read back and left alone.
+ * Unlike NOR and SPI flash, an erased-looking block is still erased:
+ * the data area reading 0xff says nothing about the ECC bytes in OOB.
+ */
 int ranand_erase_write(char *buf, unsigned int offs, int count)
 {
 	int blocksize = CFG_BLOCKSIZE;
 	int blockmask = blocksize - 1;
 	int rc, i = 0;
+	int total = 0, same = 0;
 
 	printf("%s: offs:%x, count:%x\n", __func__, offs, count);
 
@@ -972,6 +1282,13 @@ try_next_0:
 
 			piece = offs & blockmask;
 			piece_size = min(count, blocksize - piece);
+			total++;
+			if (memcmp(block + piece, buf, piece_size) == 0) {
+				same++;
+				free(temp);
+				free(block);
+				goto next_0;
+			}
 			memcpy(block + piece, buf, piece_size);
 
 			rc = ranand_erase(blockaddr, blocksize);
@@ -1017,7 +1334,7 @@ try_next_0:
 
                         free(temp);
 			free(block);
-
+next_0:
 			buf += piece_size;
 			offs += piece_size;
 			count -= piece_size;
@@ -1029,6 +1346,16 @@ try_next_0:
 			temp = malloc(blocksize);	
 			if (!temp)
 				return -1;
+			total++;
+#ifdef CONFIG_BADBLOCK_CHECK
+			if (!ranand_block_isbad(offs))
+#endif
+			if (ranand_read(temp, offs, aligned_size) == aligned_size &&
+			    memcmp(buf, temp, aligned_size) == 0) {
+				same++;
+				free(temp);
+				goto next_1;
+			}
 try_next_1:
 			rc = ranand_erase(offs, aligned_size);
 #ifdef CONFIG_BADBLOCK_CHECK
@@ -1072,7 +1399,7 @@ try_next_1:
 			}
 #endif
 			free(temp);
-			
+next_1:
 			printf(".");
 
 			buf += aligned_size;
@@ -1080,13 +1407,43 @@ try_next_1:
 			count -= aligned_size;
 		}
 	}
-	printf("Done!\n");
+	printf("Done! %d blocks: %d unchanged\n", total, same);
 	return 0;
 }
 
 
 #define NAND_FLASH_DBG_CMD
 #ifdef NAND_FLASH_DBG_CMD
+extern unsigned long mips_cpu_feq;
+
+/* time one ranand_read() to the load address */
+static void ranand_bench(unsigned int addr, int len, int dma)
+{
+	ulong tick_per_us = (mips_cpu_feq / 2) / 1000000;
+	ulong t, us, ms;
+	int use = nfc_use_dma;
+
+	if (dma && !use) {
+		printf("   gdma: off\n");
+		return;
+	}
+	nfc_use_dma = dma;
+	t = get_timer(0);
+	len = ranand_read((char *)CFG_LOAD_ADDR, addr, len);
+	t = get_timer(t);
+	/* a transfer that failed has turned GDMA off for good */
+	if (!dma)
+		nfc_use_dma = use;
+	if (len < 0) {
+		printf("read failed\n");
+		return;
+	}
+	us = t / tick_per_us;
+	ms = (us < 1000) ? 1 : us / 1000;
+	printf("   %s: %d bytes in %lu us, %lu kB/s\n", dma ? "gdma" : "pio ",
+		len, us, ((ulong)len >> 10) * 1000 / ms);
+}
+
 int ralink_nand_command(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 {
 	unsigned int addr;
@@ -1133,6 +1490,31 @@ int ralink_nand_command(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 		else
 			printf("erase succeed\n");
 	}
+	else if (!strncmp(argv[1], "ecc", 4)) {
+		for (i = 0, len = 0; i < CFG_NUMBLOCK; i++)
+			if (nand_ecc_errs[i]) {
+				printf("block at 0x%08x: %d ECC errors\n",
+						i << (CONFIG_PAGE_SIZE_BIT + CONFIG_NUMPAGE_PER_BLOCK_BIT),
+						nand_ecc_errs[i]);
+				len++;
+			}
+		printf("%d blocks with ECC errors\n", len);
+	}
+	else if (!strncmp(argv[1], "bench", 6)) {
+		addr = (unsigned int)simple_strtoul(argv[2], NULL, 16);
+		len = (int)simple_strtoul(argv[3], NULL, 16);
+		ranand_bench(addr, len, 0);
+		ranand_bench(addr, len, 1);
+	}
+#ifdef CONFIG_BADBLOCK_CHECK
+	else if (!strncmp(argv[1], "bbt", 4)) {
+		len = ranand_bbt_scan();
+		for (i = 0; i < CFG_NUMBLOCK; i++)
+			if ((nand_bbt[i >> 3] >> (i & 7)) & 1)
+				printf("bad block at 0x%08x\n", i << BLOCK_SHIFT);
+		printf("%d bad blocks\n", len);
+	}
+#endif
 	else
 		printf("Usage:\n%s\n use \"help nand\" for detail!\n", cmdtp->usage);
 	return 0;
@@ -1146,5 +1528,8 @@ U_BOOT_CMD(
 	"  nand read <addr> <len>\n"
 	"  nand page <number>\n"
 	"  nand erase <addr> <len>\n"
+	"  nand bench <addr> <len> - read throughput, pio and gdma\n"
+	"  nand ecc - blocks with ECC errors on read since power-up\n"
+	"  nand bbt - rescan the bad block markers\n"
 );
 #endif
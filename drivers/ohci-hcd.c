@@ -67,6 +67,7 @@
 #endif
 
 #include <malloc.h>
+#include <dma_pool.h>
 #include <usb.h>
 
 #include "ohci.h"
@@ -228,6 +229,7 @@ max = urb->actual_length;
 
 				if(td->data_copy)
 					free(td->data_copy);
+				dma_pool_free(&ohci_td_pool, td);
 			}
 		}
 	}
@@ -2033,12 +2035,8 @@ int usb_lowlevel_init(void)
 		err("EDs not aligned!!");
 		return -1;
 	}
-	memset(gtd, 0, sizeof(td_t) * (NUM_TD + 1));
-	if ((__u32)gtd & 0x7) {
-		err("TDs not aligned!!");
+	if (dma_pool_init(&ohci_td_pool, "ohci_td", sizeof(td_t), CFG_OHCI_TD_NUM) != 0)
 		return -1;
-	}
-	ptd_dma = (struct td_t *)KSEG1ADDR((ulong)gtd);
 	gohci.hcca = phcca;
 	memset(phcca, 0, sizeof(struct ohci_hcca));
 
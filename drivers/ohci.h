@@ -456,30 +456,22 @@ static ed_t * ep_add_ed(struct usb_device * usb_dev, unsigned long pipe,
 /*-------------------------------------------------------------------------*/
 
 /* we need more TDs than EDs */
-#define NUM_TD 64
+#ifndef CFG_OHCI_TD_NUM
+#define CFG_OHCI_TD_NUM 64
+#endif
 
-/* +1 so we can align the storage */
-td_t gtd[NUM_TD+1];
-/* pointers to aligned storage */
-td_t *ptd_dma;
+/* uncached, aligned storage */
+static struct dma_pool ohci_td_pool;
 
 /* TDs ... */
 static inline struct td *
 td_alloc (struct usb_device *usb_dev)
 {
-	int i;
 	struct td	*td;
 
-	td = NULL;
-	for (i = 0; i < NUM_TD; i++)
-	{
-		if (ptd_dma[i].usb_dev == NULL)
-		{
-			td = &ptd_dma[i];
-			td->usb_dev = usb_dev;
-			break;
-		}
-	}
+	td = dma_pool_alloc(&ohci_td_pool);
+	if (td)
+		td->usb_dev = usb_dev;
 
 	return td;
 }
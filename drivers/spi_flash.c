@@ -3,6 +3,8 @@
 #include <rt_mmap.h>
 #include <configs/rt2880.h>
 #include <malloc.h>
+#include <gdma_api.h>
+#include <spi_api.h>
 #include "ralink_spi.h"
 
 
@@ -20,10 +22,16 @@
 #define OPCODE_RDSR		5	/* Read status register */
 #define OPCODE_WRSR		1	/* Write status register */
 #define OPCODE_READ		3	/* Read data bytes */
+#define OPCODE_FAST_READ	0x0B	/* Read data bytes, one dummy byte */
 #define OPCODE_PP		2	/* Page program */
 #define OPCODE_SE		0xD8	/* Sector erase */
+#define OPCODE_CE		0xC7	/* Chip erase */
 #define OPCODE_RES		0xAB	/* Read Electronic Signature */
 #define OPCODE_RDID		0x9F	/* Read JEDEC ID */
+#define OPCODE_RDSFDP		0x5A	/* Read SFDP, one dummy byte */
+#define OPCODE_READ4B		0x13	/* READ with 4-byte address */
+#define OPCODE_FAST_READ4B	0x0C	/* FAST_READ with 4-byte address */
+#define OPCODE_PP4B		0x12	/* PP with 4-byte address */
 
 /* Status Register bits. */
 #define SR_WIP			1	/* Write in progress */
@@ -34,8 +42,11 @@
 #define SR_EPE			0x20	/* Erase/Program error */
 #define SR_SRWD			0x80	/* SR write protect */
 
+/* tools/spisim supplies its own register accessors */
+#ifndef ra_inl
 #define ra_inl(addr)  (*(volatile u32 *)(addr))
 #define ra_outl(addr, value)  (*(volatile u32 *)(addr) = (value))
+#endif
 #define ra_and(addr, value) ra_outl(addr, (ra_inl(addr) & (value)))
 #define ra_or(addr, value) ra_outl(addr, (ra_inl(addr) | (value)))
 
@@ -43,9 +54,13 @@
 #define ra_dbg(args...) do { if (1) printf(args); } while(0)
 
 static unsigned int spi_wait_nsec = 0;
+static u8 spi_read_op = OPCODE_READ;
+#ifdef CFG_SPI_MMAP_SIZE
+static u32 spi_mmap_len = 0;	/* usable part of the mapped window */
+#endif
 
 
-static int spic_busy_wait(void)
+static inline int spic_busy_wait(void)
 {
 	do {
 		if ((ra_inl(RT2880_SPISTAT_REG) & 0x01) == 0)
@@ -72,6 +87,7 @@ static int spic_busy_wait(void)
 static int spic_transfer(const u8 *cmd, int n_cmd, u8 *buf, int n_buf, int flag)
 {
 	int retval = -1;
+	u32 ctl;
 	/*
 	ra_dbg("cmd(%x): %x %x %x %x , buf:%x len:%x, flag:%s \n",
 			n_cmd, cmd[0], cmd[1], cmd[2], cmd[3],
@@ -81,11 +97,18 @@ static int spic_transfer(const u8 *cmd, int n_cmd, u8 *buf, int n_buf, int flag)
 
 	// assert CS and we are already CLK normal high
 	ra_and(RT2880_SPICTL_REG, ~(SPICTL_SPIENA_HIGH));
+
+	/*
+	 * Nothing else touches SPICTL during the transfer, so each byte
+	 * starts with a plain write of the cached value instead of a
+	 * read-modify-write: three register accesses per byte, not four.
+	 */
+	ctl = ra_inl(RT2880_SPICTL_REG);
 	
 	// write command
 	for (retval = 0; retval < n_cmd; retval++) {
 		ra_outl(RT2880_SPIDATA_REG, cmd[retval]);
-		ra_or(RT2880_SPICTL_REG, SPICTL_STARTWR);
+		ra_outl(RT2880_SPICTL_REG, ctl | SPICTL_STARTWR);
 		if (spic_busy_wait()) {
 			retval = -1;
 			goto end_trans;
@@ -95,7 +118,7 @@ static int spic_transfer(const u8 *cmd, int n_cmd, u8 *buf, int n_buf, int flag)
 	// read / write  data
 	if (flag & SPIC_READ_BYTES) {
 		for (retval = 0; retval < n_buf; retval++) {
-			ra_or(RT2880_SPICTL_REG, SPICTL_STARTRD);
+			ra_outl(RT2880_SPICTL_REG, ctl | SPICTL_STARTRD);
 			if (n_cmd != 1 && (retval & 0xffff) == 0) {
 				printf(".");
 			}
@@ -110,7 +133,7 @@ static int spic_transfer(const u8 *cmd, int n_cmd, u8 *buf, int n_buf, int flag)
 	else if (flag & SPIC_WRITE_BYTES) {
 		for (retval = 0; retval < n_buf; retval++) {
 			ra_outl(RT2880_SPIDATA_REG, buf[retval]);
-			ra_or(RT2880_SPICTL_REG, SPICTL_STARTWR);
+			ra_outl(RT2880_SPICTL_REG, ctl | SPICTL_STARTWR);
 			if (spic_busy_wait()) {
 				goto end_trans;
 			}
@@ -135,6 +158,31 @@ static int spic_write(const u8 *cmd, size_t n_cmd, const u8 *txbuf, size_t n_tx)
 }
 
 extern unsigned long mips_bus_feq;
+
+/*
+ * Smallest SPICFG_SPICLK_DIVx setting that keeps the SPI clock, the bus
+ * clock divided by 2 << div, at or below 'mhz'.
+ */
+static int spic_clk_div(unsigned int mhz)
+{
+	int div;
+
+	for (div = SPICFG_SPICLK_DIV2; div < SPICFG_SPICLK_DIV128; div++)
+		if (mips_bus_feq / (2 << div) <= mhz * 1000 * 1000)
+			break;
+	return div;
+}
+
+/* SPICFG_SPICLK_DIVx in use, a smaller one is a faster clock */
+static int spi_clk_div = SPICFG_SPICLK_DIV4;
+
+static void spic_set_clk(int div)
+{
+	spi_clk_div = div;
+	ra_outl(RT2880_SPICFG_REG, (ra_inl(RT2880_SPICFG_REG) & ~0x7) | div);
+	spi_wait_nsec = (8 * 1000 / ((mips_bus_feq / 1000 / 1000 / (2 << div)) )) >> 1 ;
+}
+
 int spic_init(void)
 {
 	// use normal(SPI) mode instead of GPIO mode
@@ -147,6 +195,7 @@ int spic_init(void)
 
 	// FIXME, clk_div should depend on spi-flash.
 	ra_outl(RT2880_SPICFG_REG, SPICFG_MSBFIRST | SPICFG_TXCLKEDGE_FALLING | SPICFG_SPICLK_DIV4 | SPICFG_SPICLKPOL);
+	spi_clk_div = SPICFG_SPICLK_DIV4;
 								
 	// set idle state
 	ra_outl(RT2880_SPICTL_REG, SPICTL_HIZSDO | SPICTL_SPIENA_HIGH);
@@ -159,6 +208,22 @@ int spic_init(void)
 
 
 
+#define SPI_ERASE_TYPES		4
+#define SPI_ERASE_MS(size)	(30 + (size) / 256)	/* rough, without SFDP */
+#define SPI_PAGE_US		600	/* rough page program time, without SFDP */
+
+/* give up on a busy chip after this long */
+#define SPI_WAIT_MS		2000
+#define SPI_ERASE_WAIT_MS	3000
+#define SPI_CHIP_WAIT_MS	480000
+
+struct spi_erase {
+	u32		size;		/* 0 for an unused slot */
+	u8		op;
+	u8		op4b;		/* the same with a 4-byte address */
+	u16		ms;		/* typical erase time */
+};
+
 struct chip_info {
 	char		*name;
 	u8		id;
@@ -166,29 +231,37 @@ struct chip_info {
 	unsigned long	sector_size;
 	unsigned int	n_sectors;
 	char		addr4b;
+	u8		fast_mhz;	/* FAST_READ clock limit, 0 if unsupported */
+
+	/* the rest is filled in by chip_prob(), from SFDP if the part has it */
+	struct spi_erase erase[SPI_ERASE_TYPES];	/* smallest first */
+	u32		chip_ms;	/* typical chip erase time, 0 if unknown */
+	char		native4b;	/* 4-byte opcodes instead of EN4B/EX4B */
+	u32		page_size;
+	u32		page_us;	/* typical page program time */
 };
 struct chip_info *spi_chip_info;
 
 static struct chip_info chips_data [] = {
 	/* REVISIT: fill in JEDEC ids, for parts that have them */
-	{ "AT25DF321",		0x1f, 0x47000000, 64 * 1024, 64,  0 },
-	{ "AT26DF161",		0x1f, 0x46000000, 64 * 1024, 32,  0 },
-	{ "FL016AIF",		0x01, 0x02140000, 64 * 1024, 32,  0 },
-	{ "FL064AIF",		0x01, 0x02160000, 64 * 1024, 128, 0 },
-	{ "MX25L1605D",		0xc2, 0x2015c220, 64 * 1024, 32,  0 },
-	{ "MX25L3205D",		0xc2, 0x2016c220, 64 * 1024, 64,  0 },
-	{ "MX25L6405D",		0xc2, 0x2017c220, 64 * 1024, 128, 0 },
-	{ "MX25L12805D",	0xc2, 0x2018c220, 64 * 1024, 256, 0 },
+	{ "AT25DF321",		0x1f, 0x47000000, 64 * 1024, 64,  0,  66 },
+	{ "AT26DF161",		0x1f, 0x46000000, 64 * 1024, 32,  0,  66 },
+	{ "FL016AIF",		0x01, 0x02140000, 64 * 1024, 32,  0,  50 },
+	{ "FL064AIF",		0x01, 0x02160000, 64 * 1024, 128, 0,  50 },
+	{ "MX25L1605D",		0xc2, 0x2015c220, 64 * 1024, 32,  0,  86 },
+	{ "MX25L3205D",		0xc2, 0x2016c220, 64 * 1024, 64,  0,  86 },
+	{ "MX25L6405D",		0xc2, 0x2017c220, 64 * 1024, 128, 0,  86 },
+	{ "MX25L12805D",	0xc2, 0x2018c220, 64 * 1024, 256, 0,  50 },
 #ifdef MX_4B_MODE 
-	{ "MX25L25635E",	0xc2, 0x2019c220, 64 * 1024, 512, 1 },
+	{ "MX25L25635E",	0xc2, 0x2019c220, 64 * 1024, 512, 1,  80 },
 #endif
-	{ "S25FL128P",		0x01, 0x20180301, 64 * 1024, 256, 0 },
-	{ "S25FL129P",		0x01, 0x20184D01, 64 * 1024, 256, 0 },
-	{ "S25FL032P",		0x01, 0x02154D00, 64 * 1024, 64,  0 },
-	{ "S25FL064P",		0x01, 0x02164D00, 64 * 1024, 128, 0 },
-	{ "EN25F16",		0x1c, 0x31151c31, 64 * 1024, 32,  0 },
-	{ "EN25F32",		0x1c, 0x31161c31, 64 * 1024, 64,  0 },
-	{ "W25Q32BV",		0xef, 0x40160000, 64 * 1024, 64,  0 },
+	{ "S25FL128P",		0x01, 0x20180301, 64 * 1024, 256, 0, 104 },
+	{ "S25FL129P",		0x01, 0x20184D01, 64 * 1024, 256, 0, 104 },
+	{ "S25FL032P",		0x01, 0x02154D00, 64 * 1024, 64,  0, 104 },
+	{ "S25FL064P",		0x01, 0x02164D00, 64 * 1024, 128, 0, 104 },
+	{ "EN25F16",		0x1c, 0x31151c31, 64 * 1024, 32,  0, 100 },
+	{ "EN25F32",		0x1c, 0x31161c31, 64 * 1024, 64,  0, 100 },
+	{ "W25Q32BV",		0xef, 0x40160000, 64 * 1024, 64,  0,  80 },
 };
 
 
@@ -272,6 +345,63 @@ static int raspi_4byte_mode(int enable)
 }
 #endif
 
+/*
+ * Parts above 16 MB without native 4-byte opcodes are switched to
+ * 4-byte mode around each access, and back so that a reset finds them
+ * in 3-byte mode.
+ */
+static void raspi_4b_enter(void)
+{
+#ifdef MX_4B_MODE
+	if (spi_chip_info->addr4b && !spi_chip_info->native4b)
+		raspi_4byte_mode(1);
+#endif
+}
+
+static void raspi_4b_exit(void)
+{
+#ifdef MX_4B_MODE
+	if (spi_chip_info->addr4b && !spi_chip_info->native4b)
+		raspi_4byte_mode(0);
+#endif
+}
+
+/*
+ * Set up opcode 'op' and address 'addr' in 'cmd', switching to the
+ * 4-byte opcode where the part has one.  Returns the length.
+ */
+static int raspi_cmd_addr(u8 *cmd, u8 op, u32 addr)
+{
+	int n = 0;
+
+	cmd[n++] = op;
+#ifdef MX_4B_MODE
+	if (spi_chip_info->addr4b) {
+		if (spi_chip_info->native4b) {
+			if (op == OPCODE_READ)
+				cmd[0] = OPCODE_READ4B;
+			else if (op == OPCODE_FAST_READ)
+				cmd[0] = OPCODE_FAST_READ4B;
+			else if (op == OPCODE_PP)
+				cmd[0] = OPCODE_PP4B;
+			else {
+				struct spi_erase *e = spi_chip_info->erase;
+				int i;
+
+				for (i = 0; i < SPI_ERASE_TYPES && e[i].size; i++)
+					if (op == e[i].op)
+						cmd[0] = e[i].op4b;
+			}
+		}
+		cmd[n++] = addr >> 24;
+	}
+#endif
+	cmd[n++] = addr >> 16;
+	cmd[n++] = addr >> 8;
+	cmd[n++] = addr;
+	return n;
+}
+
 /*
  * Set write enable latch with Write Enable command.
  * Returns negative if error occurred.
@@ -306,25 +436,52 @@ static inline int raspi_unprotect(void)
  * Service routine to read status register until ready, or timeout occurs.
  * Returns non-zero if error.
  */
-static int raspi_wait_ready(int sleep_ms)
+/* udelay() counts CPU cycles in 32 bits, keep each call well short of that */
+static void raspi_sleep_us(u32 us)
 {
-	int count;
+	u32 n;
+
+	while (us > 0) {
+		n = (us > 100000) ? 100000 : us;
+		udelay(n);
+		us -= n;
+	}
+}
+
+/*
+ * Wait until the chip is no longer busy.  'typ_us' is the typical time
+ * of the operation just started, 0 if nothing was.  The status is read
+ * at once, then after 7/8 of 'typ_us', and from there on every eighth
+ * of it (10 us to 1 ms) until 'max_ms' have passed.
+ */
+static int raspi_wait_ready(u32 typ_us, u32 max_ms)
+{
+	u32 step, waited = 0;
 	int sr = 0;
 
-	//udelay(1000 * sleep_ms);
+	step = typ_us / 8;
+	if (step < 10)
+		step = 10;
+	else if (step > 1000)
+		step = 1000;
 
-	/* one chip guarantees max 5 msec wait here after page writes,
-	 * but potentially three seconds (!) after page erase.
-	 */
-	for (count = 0;  count < ((sleep_ms+1) *1000); count++) {
+	for (;;) {
 		if ((raspi_read_sr((u8 *)&sr)) < 0)
 			break;
 		else if (!(sr & (SR_WIP | SR_EPE | SR_WEL))) {
 			return 0;
 		}
+		if (waited >= max_ms * 1000)
+			break;
 
-		udelay(500);
-		/* REVISIT sometimes sleeping would be best */
+		if (waited == 0 && typ_us > step) {
+			raspi_sleep_us(typ_us - typ_us / 8);
+			waited = typ_us - typ_us / 8;
+		}
+		else {
+			udelay(step);
+			waited += step;
+		}
 	}
 
 	printf("%s: read_sr fail: %x\n", __func__, sr);
@@ -332,44 +489,182 @@ static int raspi_wait_ready(int sleep_ms)
 }
 
 /*
- * Erase one sector of flash memory at offset ``offset'' which is any
- * address within the sector which should be erased.
+ * Erase the block of erase type 'e' at ``offset'', or the whole chip
+ * when 'e' is NULL.
  *
  * Returns 0 if successful, non-zero otherwise.
  */
-static int raspi_erase_sector(u32 offset)
+static int raspi_erase_block(const struct spi_erase *e, u32 offset)
 {
 	u8 buf[5];
 
 	/* Wait until finished previous write command. */
-	if (raspi_wait_ready(950))
+	if (raspi_wait_ready(0, SPI_WAIT_MS))
 		return -1;
 
 	/* Send write enable, then erase commands. */
 	raspi_write_enable();
 	raspi_unprotect();
 
-#ifdef MX_4B_MODE
-	if (spi_chip_info->addr4b) {
-		raspi_4byte_mode(1);
-		buf[0] = OPCODE_SE;
-		buf[1] = offset >> 24;
-		buf[2] = offset >> 16;
-		buf[3] = offset >> 8;
-		buf[4] = offset;
-		spic_write(buf, 5, 0 , 0);
-		raspi_4byte_mode(0);
-		return 0;
+	if (e == NULL) {
+		buf[0] = OPCODE_CE;
+		spic_write(buf, 1, 0 , 0);
+		return raspi_wait_ready(spi_chip_info->chip_ms * 1000, SPI_CHIP_WAIT_MS);
 	}
-#endif
+	raspi_4b_enter();
+	spic_write(buf, raspi_cmd_addr(buf, e->op, offset), 0 , 0);
+	raspi_4b_exit();
+	return raspi_wait_ready(e->ms * 1000, SPI_ERASE_WAIT_MS);
+}
+
+/******************************************************************************
+ * SFDP (JESD216) parameter tables
+ ******************************************************************************/
+
+#define SFDP_SIGNATURE		0x50444653	/* "SFDP" */
+#define SFDP_BFPT_ID		0xFF00		/* Basic Flash Parameter Table */
+#define SFDP_4BAIT_ID		0xFF84		/* 4-byte Address Instruction Table */
+#define SFDP_MAX_HEADERS	8
+#define SFDP_BFPT_DWORDS	16
+
+/* the layout assumes 64 kB blocks, never erase more than that at once */
+#define SFDP_MAX_ERASE		(64 * 1024)
+
+static struct chip_info sfdp_chip = { "SFDP" };
+
+static int raspi_read_sfdp(u32 addr, u8 *buf, int len)
+{
+	u8 cmd[5];
+
+	cmd[0] = OPCODE_RDSFDP;
+	cmd[1] = addr >> 16;
+	cmd[2] = addr >> 8;
+	cmd[3] = addr;
+	cmd[4] = 0;
+	return (spic_read(cmd, 5, buf, len) == len) ? 0 : -1;
+}
+
+/* SFDP dword 'n', counted from 1 as in JESD216 */
+static u32 sfdp_dw(const u8 *p, int n)
+{
+	p += (n - 1) * 4;
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24);
+}
+
+/* JESD216A typical erase times: count + 1 in one of four units */
+static u32 sfdp_time(u32 field, const u32 *unit)
+{
+	return ((field & 0x1f) + 1) * unit[(field >> 5) & 3];
+}
+
+/*
+ * Read the SFDP tables into 'info'.  An entry from chips_data keeps its
+ * geometry and takes the erase types up to its sector size, the page
+ * size and the 4-byte opcodes; an empty entry (sector_size 0) also gets
+ * its size, with the largest erase block up to SFDP_MAX_ERASE as sector.
+ * Returns 0 if the part has usable SFDP.
+ */
+static int raspi_sfdp(struct chip_info *info)
+{
+	static const u32 erase_unit[4] = { 1, 16, 128, 1000 };
+	static const u32 chip_unit[4] = { 16, 256, 4000, 64000 };
+	u8 hdr[8 + SFDP_MAX_HEADERS * 8], bfpt[SFDP_BFPT_DWORDS * 4], a4b[8];
+	u32 bfpt_ptr = 0, a4b_ptr = 0, dw, size, a4b_dw1 = 0, a4b_ops = 0;
+	struct spi_erase erase[SPI_ERASE_TYPES], *e;
+	int nph, len = 0, i, j, n_erase = 0, native4b;
+
+	if (raspi_read_sfdp(0, hdr, 8) || sfdp_dw(hdr, 1) != SFDP_SIGNATURE)
+		return -1;
+	nph = hdr[6] + 1;
+	if (nph > SFDP_MAX_HEADERS)
+		nph = SFDP_MAX_HEADERS;
+	if (raspi_read_sfdp(8, hdr + 8, nph * 8))
+		return -1;
+	for (i = 0; i < nph; i++) {
+		u8 *ph = hdr + 8 + i * 8;
+		u32 id = ph[0] | (ph[7] << 8);
+		u32 ptr = ph[4] | (ph[5] << 8) | (ph[6] << 16);
+
+		if (id == SFDP_BFPT_ID && ph[2] == 1 && !bfpt_ptr) {
+			bfpt_ptr = ptr;
+			len = ph[3];
+		}
+		else if (id == SFDP_4BAIT_ID && ph[3] >= 2)
+			a4b_ptr = ptr;
+	}
+	if (!bfpt_ptr || len < 9)
+		return -1;
+	if (len > SFDP_BFPT_DWORDS)
+		len = SFDP_BFPT_DWORDS;
+	memset(bfpt, 0, sizeof(bfpt));
+	if (raspi_read_sfdp(bfpt_ptr, bfpt, len * 4))
+		return -1;
+
+	/* density, in bits */
+	dw = sfdp_dw(bfpt, 2);
+	if (dw & 0x80000000) {
+		dw &= 0x7fffffff;
+		if (dw < 3 || dw > 34)
+			return -1;
+		size = 1 << (dw - 3);
+	}
+	else
+		size = (dw >> 3) + 1;
 
-	/* Set up command buffer. */
-	buf[0] = OPCODE_SE;
-	buf[1] = offset >> 16;
-	buf[2] = offset >> 8;
-	buf[3] = offset;
+	/*
+	 * Native 4-byte commands need READ4B, FAST_READ4B, PP4B and a 4-byte
+	 * version of every erase type kept below.
+	 */
+	native4b = 0;
+	if ((info->sector_size ? info->addr4b : size > 0x1000000) &&
+	    a4b_ptr && raspi_read_sfdp(a4b_ptr, a4b, 8) == 0) {
+		a4b_dw1 = sfdp_dw(a4b, 1);
+		a4b_ops = sfdp_dw(a4b, 2);
+		native4b = ((a4b_dw1 & 0x43) == 0x43);
+	}
+
+	/* erase types 1-4: size exponent in the low byte, opcode above it */
+	for (i = 0; i < 4; i++) {
+		u32 et = sfdp_dw(bfpt, 8 + i / 2) >> ((i & 1) * 16);
+		u32 n = et & 0xff;
+
+		if (n == 0 || n > 31 || (1UL << n) > SFDP_MAX_ERASE ||
+		    (info->sector_size && (1UL << n) > info->sector_size))
+			continue;
+		/* insertion sort, smallest first */
+		for (j = n_erase++; j > 0 && erase[j - 1].size > (1UL << n); j--)
+			erase[j] = erase[j - 1];
+		e = &erase[j];
+		e->size = 1UL << n;
+		e->op = (et >> 8) & 0xff;
+		e->op4b = (a4b_dw1 & (1 << (9 + i))) ? (a4b_ops >> (i * 8)) & 0xff : 0;
+		if (native4b && e->op4b == 0)
+			native4b = 0;
+		if (len >= 10)
+			e->ms = sfdp_time(sfdp_dw(bfpt, 10) >> (4 + i * 7), erase_unit);
+		else
+			e->ms = SPI_ERASE_MS(e->size);
+	}
+	if (n_erase == 0 || (info->sector_size &&
+	    erase[n_erase - 1].size != info->sector_size))
+		return -1;
+
+	if (info->sector_size == 0) {
+		info->sector_size = erase[n_erase - 1].size;
+		info->n_sectors = size / info->sector_size;
+		info->addr4b = (size > 0x1000000);
+		info->fast_mhz = 50;
+	}
+	memset(info->erase, 0, sizeof(info->erase));
+	memcpy(info->erase, erase, n_erase * sizeof(erase[0]));
+	info->native4b = native4b;
+	if (len >= 11) {
+		dw = sfdp_dw(bfpt, 11);
+		info->page_size = 1 << ((dw >> 4) & 0xf);
+		info->page_us = (((dw >> 8) & 0x1f) + 1) * ((dw & (1 << 13)) ? 64 : 8);
+		info->chip_ms = sfdp_time(dw >> 24, chip_unit);
+	}
 
-	spic_write(buf, 4, 0 , 0);
 	return 0;
 }
 
@@ -387,13 +682,14 @@ struct chip_info *chip_prob(void)
 
 	// FIXME, assign default as AT25D
 	weight = 0xffffffff;
-	match = &chips_data[0];
+	match = NULL;
 	for (i = 0; i < sizeof(chips_data)/sizeof(chips_data[0]); i++) {
 		info = &chips_data[i];
 		if (info->id == buf[0]) {
 			if (info->jedec_id == jedec) {
 				printf("find flash: %s\n", info->name);
-				return info;
+				match = info;
+				break;
 			}
 
 			if (weight > (info->jedec_id ^ jedec)) {
@@ -402,34 +698,154 @@ struct chip_info *chip_prob(void)
 			}
 		}
 	}
-	printf("Warning: un-recognized chip ID, please update bootloader!\n");
+
+	if (match == NULL || match->jedec_id != jedec) {
+		/* an unknown part describes itself better than a near match */
+		sfdp_chip.id = buf[0];
+		sfdp_chip.jedec_id = jedec;
+		sfdp_chip.page_size = FLASH_PAGESIZE;
+		sfdp_chip.page_us = SPI_PAGE_US;
+		if (raspi_sfdp(&sfdp_chip) == 0) {
+			printf("find flash: SFDP, %lu x %lu kB sectors\n",
+				(ulong)sfdp_chip.n_sectors, sfdp_chip.sector_size >> 10);
+			return &sfdp_chip;
+		}
+		printf("Warning: un-recognized chip ID, please update bootloader!\n");
+		if (match == NULL)
+			match = &chips_data[0];
+	}
+
+	/* without SFDP the part keeps these */
+	match->erase[0].size = match->sector_size;
+	match->erase[0].op = OPCODE_SE;
+	match->erase[0].ms = SPI_ERASE_MS(match->sector_size);
+	match->page_size = FLASH_PAGESIZE;
+	match->page_us = SPI_PAGE_US;
+	raspi_sfdp(match);
 
 	return match;
 }
 
+/*
+ * Plain READ is specified for about 33 MHz only and keeps the divider
+ * spic_init() starts with.  FAST_READ, and every other command on parts
+ * that have it, runs as fast as the chip allows.
+ */
+static void raspi_read_mode(int fast)
+{
+	if (fast && spi_chip_info->fast_mhz) {
+		spi_read_op = OPCODE_FAST_READ;
+		spic_set_clk(spic_clk_div(spi_chip_info->fast_mhz));
+	}
+	else {
+		spi_read_op = OPCODE_READ;
+		spic_set_clk(SPICFG_SPICLK_DIV4);
+	}
+}
+
+#ifdef CFG_SPI_MMAP_SIZE
+#define SPI_MMAP_PROBES		16
+
+/*
+ * Trust the memory mapped window only where it reads the same as the
+ * command interface.  32 bytes are compared at every sixteenth of the
+ * window and at its end.  A block that reads erased both ways says
+ * little about a window that is smaller or wraps, so the window is only
+ * used up to the end of the last block that held data and matched; the
+ * rest goes through commands until the next boot.  Call this at READ's
+ * clock, the one the window runs at.
+ */
+static void raspi_mmap_probe(void)
+{
+	u32 size = spi_chip_info->sector_size * spi_chip_info->n_sectors;
+	u32 len = (size < CFG_SPI_MMAP_SIZE) ? size : CFG_SPI_MMAP_SIZE;
+	u32 offs, used = 0;
+	u8 pio[32];
+	int k, i;
+
+	spi_mmap_len = 0;
+	for (k = 0; k <= SPI_MMAP_PROBES; k++) {
+		offs = (k < SPI_MMAP_PROBES) ? len / SPI_MMAP_PROBES * k :
+			len - sizeof(pio);
+		if (raspi_read((char *)pio, offs, sizeof(pio)) != sizeof(pio) ||
+		    memcmp(pio, (void *)(CFG_FLASH_BASE + offs), sizeof(pio)) != 0)
+			return;
+		for (i = 0; i < sizeof(pio); i++)
+			if (pio[i] != 0xff) {
+				used = offs + sizeof(pio);
+				break;
+			}
+	}
+	spi_mmap_len = used;
+}
+#endif
+
 unsigned long raspi_init(void)
 {
 	spic_init();
 	spi_chip_info = chip_prob();
+#ifdef CFG_SPI_MMAP_SIZE
+	raspi_read_mode(0);
+	raspi_mmap_probe();
+#endif
+	raspi_read_mode(1);
 	return spi_chip_info->sector_size * spi_chip_info->n_sectors;
 }
 
+/* commands issued by the last raspi_erase(), per erase type, chip last */
+static int spi_erase_count[SPI_ERASE_TYPES + 1];
+
+/*
+ * Erase [offs, offs + len), widened to whole units of the smallest erase
+ * type.  best[k] is the cheapest way to clear an aligned block of type k,
+ * either its own command or the blocks of type k - 1 it is made of; the
+ * range is walked with the largest aligned type that fits and is worth
+ * using.  Erasing the whole chip uses chip erase if that is quicker.
+ */
 int raspi_erase(unsigned int offs, int len)
 {
+	struct spi_erase *e = spi_chip_info->erase;
+	u32 unit = e[0].size, end, best[SPI_ERASE_TYPES];
+	int use[SPI_ERASE_TYPES], n, k;
+
 	ra_dbg("%s: offs:%x len:%x\n", __func__, offs, len);
 
 	/* sanity checks */
 	if (len == 0)
 		return 0;
 
-	/* now erase those sectors */
-	while (len > 0) {
-		if (raspi_erase_sector(offs)) {
-			return -1;
+	end = (offs + len + unit - 1) & ~(unit - 1);
+	offs &= ~(unit - 1);
+	if (flash_gen_bump(CFG_FLASH_BASE + offs, end - offs) != 0)
+		return -1;
+
+	for (n = 0; n < SPI_ERASE_TYPES && e[n].size; n++) {
+		best[n] = e[n].ms;
+		use[n] = 1;
+		if (n > 0 && (e[n].size / e[n - 1].size) * best[n - 1] < best[n]) {
+			best[n] = (e[n].size / e[n - 1].size) * best[n - 1];
+			use[n] = 0;
 		}
+	}
+	memset(spi_erase_count, 0, sizeof(spi_erase_count));
 
-		offs += spi_chip_info->sector_size;
-		len -= spi_chip_info->sector_size;
+	if (offs == 0 && end == spi_chip_info->sector_size * spi_chip_info->n_sectors &&
+	    spi_chip_info->chip_ms &&
+	    spi_chip_info->chip_ms < spi_chip_info->n_sectors * best[n - 1]) {
+		printf("chip erase, about %lu s ", (ulong)spi_chip_info->chip_ms / 1000);
+		if (raspi_erase_block(NULL, 0))
+			return -1;
+		spi_erase_count[SPI_ERASE_TYPES]++;
+	}
+	else while (offs < end) {
+		for (k = n - 1; k > 0; k--)
+			if (use[k] && (offs & (e[k].size - 1)) == 0 &&
+			    offs + e[k].size <= end)
+				break;
+		if (raspi_erase_block(&e[k], offs))
+			return -1;
+		spi_erase_count[k]++;
+		offs += e[k].size;
 		printf(".");
 	}
 	printf("\n");
@@ -439,8 +855,8 @@ int raspi_erase(unsigned int offs, int len)
 
 int raspi_read(char *buf, unsigned int from, int len)
 {
-	u8 cmd[5];
-	int rdlen;
+	u8 cmd[6];
+	int rdlen, n_cmd;
 
 	ra_dbg("%s: from:%x len:%x \n", __func__, from, len);
 
@@ -449,33 +865,37 @@ int raspi_read(char *buf, unsigned int from, int len)
 		return 0;
 
 	/* Wait till previous write/erase is done. */
-	if (raspi_wait_ready(1)) {
+	if (raspi_wait_ready(0, SPI_WAIT_MS)) {
 		/* REVISIT status return?? */
 		return -1;
 	}
 
-	/* NOTE: OPCODE_FAST_READ (if available) is faster... */
-
-	/* Set up the write data buffer. */
-	cmd[0] = OPCODE_READ;
-#ifdef MX_4B_MODE
-	if (spi_chip_info->addr4b) {
-		raspi_4byte_mode(1);
-		cmd[1] = from >> 24;
-		cmd[2] = from >> 16;
-		cmd[3] = from >> 8;
-		cmd[4] = from;
-		rdlen = spic_read(cmd, 5, buf , len);
-		raspi_4byte_mode(0);
+#ifdef CFG_SPI_MMAP_SIZE
+	/*
+	 * Straight from the window, by GDMA when it is worth it.  The
+	 * window issues plain READ, so a clock raised for FAST_READ comes
+	 * down to READ's for the copy.
+	 */
+	if (from + len <= spi_mmap_len) {
+		int div = spi_clk_div;
+
+		if (div < SPICFG_SPICLK_DIV4)
+			spic_set_clk(SPICFG_SPICLK_DIV4);
+		dma_memcpy(buf, (void *)(CFG_FLASH_BASE + from), len);
+		if (div < SPICFG_SPICLK_DIV4)
+			spic_set_clk(div);
+		return len;
 	}
-	else
 #endif
-	{
-		cmd[1] = from >> 16;
-		cmd[2] = from >> 8;
-		cmd[3] = from;
-		rdlen = spic_read(cmd, 4, buf, len);
-	}
+
+	/* Set up the write data buffer. */
+	n_cmd = raspi_cmd_addr(cmd, spi_read_op, from);
+	/* FAST_READ clocks out one dummy byte before the data */
+	if (spi_read_op == OPCODE_FAST_READ)
+		cmd[n_cmd++] = 0;
+	raspi_4b_enter();
+	rdlen = spic_read(cmd, n_cmd, buf, len);
+	raspi_4b_exit();
 	if (rdlen != len)
 		printf("warning: rdlen != len\n");
 
@@ -484,8 +904,8 @@ int raspi_read(char *buf, unsigned int from, int len)
 
 int raspi_write(char *buf, unsigned int to, int len)
 {
-	u32 page_offset, page_size;
-	int rc = 0, retlen = 0;
+	u32 page_offset, page_size, flash_page = spi_chip_info->page_size;
+	int rc = 0, retlen = 0, n_cmd;
 	u8 cmd[5];
 
 	ra_dbg("%s: to:%x len:%x \n", __func__, to, len);
@@ -496,65 +916,34 @@ int raspi_write(char *buf, unsigned int to, int len)
 	if (to + len > spi_chip_info->sector_size * spi_chip_info->n_sectors)
 		return -1;
 
-	/* Wait until finished previous write command. */
-	if (raspi_wait_ready(2)) {
+	if (flash_gen_bump(CFG_FLASH_BASE + to, len) != 0)
 		return -1;
-	}
 
-	/* Set up the opcode in the write buffer. */
-	cmd[0] = OPCODE_PP;
-#ifdef MX_4B_MODE
-	if (spi_chip_info->addr4b) {
-		cmd[1] = to >> 24;
-		cmd[2] = to >> 16;
-		cmd[3] = to >> 8;
-		cmd[4] = to;
-	}
-	else
-#endif
-	{
-		cmd[1] = to >> 16;
-		cmd[2] = to >> 8;
-		cmd[3] = to;
+	/* Wait until finished previous write command. */
+	if (raspi_wait_ready(0, SPI_WAIT_MS)) {
+		return -1;
 	}
 
 	/* what page do we start with? */
-	page_offset = to % FLASH_PAGESIZE;
+	page_offset = to % flash_page;
 
-#ifdef MX_4B_MODE
-	raspi_4byte_mode(1);
-#endif
-	/* write everything in PAGESIZE chunks */
+	raspi_4b_enter();
+	/* write everything in page size chunks */
 	while (len > 0) {
-		page_size = min(len, FLASH_PAGESIZE-page_offset);
+		page_size = min(len, flash_page-page_offset);
 		page_offset = 0;
 		/* write the next page to flash */
-#ifdef MX_4B_MODE
-		if (spi_chip_info->addr4b) {
-			cmd[1] = to >> 24;
-			cmd[2] = to >> 16;
-			cmd[3] = to >> 8;
-			cmd[4] = to;
-		}
-		else
-#endif
-		{
-			cmd[1] = to >> 16;
-			cmd[2] = to >> 8;
-			cmd[3] = to;
-		}
+		n_cmd = raspi_cmd_addr(cmd, OPCODE_PP, to);
 
-		raspi_wait_ready(3);
 		raspi_write_enable();
 		raspi_unprotect();
 
-#ifdef MX_4B_MODE
-		if (spi_chip_info->addr4b)
-			rc = spic_write(cmd, 5, buf, page_size);
-		else
-#endif
-			rc = spic_write(cmd, 4, buf, page_size);
+		rc = spic_write(cmd, n_cmd, buf, page_size);
 		//printf("%s:: to:%x page_size:%x ret:%x\n", __func__, to, page_size, rc);
+		if (raspi_wait_ready(spi_chip_info->page_us, SPI_WAIT_MS)) {
+			raspi_4b_exit();
+			return retlen;
+		}
 		if ((retlen & 0xffff) == 0)
 			printf(".");
 
@@ -563,6 +952,7 @@ int raspi_write(char *buf, unsigned int to, int len)
 			if (rc < page_size) {
 				printf("%s: rc:%x page_size:%x\n",
 						__func__, rc, page_size);
+				raspi_4b_exit();
 				return retlen;
 			}
 		}
@@ -572,17 +962,40 @@ int raspi_write(char *buf, unsigned int to, int len)
 		buf += page_size;
 	}
 	printf("\n");
-#ifdef MX_4B_MODE
-	raspi_4byte_mode(0);
-#endif
+	raspi_4b_exit();
 
 	return retlen;
 }
 
+static int raspi_is_blank(const char *p, int len)
+{
+	while (len > 0 && ((unsigned long)p & 3)) {
+		if ((u8)*p++ != 0xff)
+			return 0;
+		len--;
+	}
+	for (; len >= 4; p += 4, len -= 4)
+		if (*(u32 *)p != 0xffffffff)
+			return 0;
+	while (len-- > 0)
+		if ((u8)*p++ != 0xff)
+			return 0;
+	return 1;
+}
+
+/*
+ * Every sector is read back first and left alone if it already holds
+ * the new data.  Otherwise only the smallest erase units that change
+ * and are not blank get erased, in runs that raspi_erase() plans, and
+ * the changed units are programmed.
+ */
 int raspi_erase_write(char *buf, unsigned int offs, int count)
 {
 	int blocksize = spi_chip_info->sector_size;
 	int blockmask = blocksize - 1;
+	int unit = spi_chip_info->erase[0].size;
+	char *block, *old;
+	int total = 0, same = 0, noerase = 0, erased = 0, ret = 0;
 
 	ra_dbg("%s: offs:%x, count:%x\n", __func__, offs, count);
 
@@ -594,118 +1007,87 @@ int raspi_erase_write(char *buf, unsigned int offs, int count)
 		return -1;
 	}
 
-	while (count > 0) {
-#define BLOCK_ALIGNE(a) (((a) & blockmask))
-		if (BLOCK_ALIGNE(offs) || (count < blocksize)) {
-			char *block;
-			unsigned int piece, blockaddr;
-			int piece_size;
-			char *temp;
-		
-			block = malloc(blocksize);
-			if (!block)
-				return -1;
-			temp = malloc(blocksize);
-			if (!temp)
-				return -1;
-
-			blockaddr = offs & ~blockmask;
-
-			if (raspi_read(block, blockaddr, blocksize) != blocksize) {
-				free(block);
-				free(temp);
-				return -2;
-			}
-
-			piece = offs & blockmask;
-			piece_size = min(count, blocksize - piece);
-			memcpy(block + piece, buf, piece_size);
-
-			if (raspi_erase(blockaddr, blocksize) != 0) {
-				free(block);
-				free(temp);
-				return -3;
-			}
-			if (raspi_write(block, blockaddr, blocksize) != blocksize) {
-				free(block);
-				free(temp);
-				return -4;
-			}
-#ifdef RALINK_SPI_UPGRADE_CHECK
-			if (raspi_read(temp, blockaddr, blocksize) != blocksize) {
-				free(block);
-				free(temp);
-				return -2;
-			}
+	block = malloc(blocksize);
+	if (!block)
+		return -1;
+	old = malloc(blocksize);
+	if (!old) {
+		free(block);
+		return -1;
+	}
 
+#define UNIT_CHANGED(u)	(memcmp(old + (u), block + (u), unit) != 0)
+#define UNIT_DIRTY(u)	(UNIT_CHANGED(u) && !raspi_is_blank(old + (u), unit))
+	while (count > 0) {
+		unsigned int piece, blockaddr;
+		int piece_size, u, v, dirty = 0;
 
-			if(memcmp(block, temp, blocksize) == 0)
-			{    
-			   // printf("block write ok!\n\r");
-			}
-			else
-			{
-				printf("block write incorrect!\n\r");
-				free(block);
-				free(temp);
-				return -2;
-			}
-#endif
-                        free(temp);
-			free(block);
+		blockaddr = offs & ~blockmask;
+		piece = offs & blockmask;
+		piece_size = min(count, blocksize - piece);
+		total++;
 
-			buf += piece_size;
-			offs += piece_size;
-			count -= piece_size;
+		if (raspi_read(old, blockaddr, blocksize) != blocksize) {
+			ret = -2;
+			goto out;
 		}
-		else {
-			unsigned int aligned_size = count & ~blockmask;
-			char *temp;
-			int i;
-			temp = malloc(blocksize);
-			if (!temp)
-				return -1;
-
-			if (raspi_erase(offs, aligned_size) != 0)
-			{
-				free(temp);
-				return -1;
+		if (memcmp(old + piece, buf, piece_size) == 0) {
+			same++;
+			goto next;
+		}
+		memcpy(block, old, blocksize);
+		memcpy(block + piece, buf, piece_size);
+
+		/* erase runs of changed units that are not blank */
+		for (u = 0; u < blocksize; u = v + unit) {
+			for (v = u; v < blocksize && UNIT_DIRTY(v); v += unit)
+				;
+			if (v > u) {
+				if (raspi_erase(blockaddr + u, v - u) != 0) {
+					ret = -3;
+					goto out;
+				}
+				dirty += v - u;
 			}
-			if (raspi_write(buf, offs, aligned_size) != aligned_size)
-			{
-				free(temp);
-				return -1;
+		}
+		if (dirty)
+			erased += dirty;
+		else
+			noerase++;
+
+		/* program runs of changed units */
+		for (u = 0; u < blocksize; u = v + unit) {
+			for (v = u; v < blocksize && UNIT_CHANGED(v); v += unit)
+				;
+			if (v > u && raspi_write(block + u, blockaddr + u, v - u) != v - u) {
+				ret = -4;
+				goto out;
 			}
-
+		}
 #ifdef RALINK_SPI_UPGRADE_CHECK
-			for( i=0; i< (aligned_size/blocksize); i++)
-			{
-				if (raspi_read(temp, offs+(i*blocksize), blocksize) != blocksize)
-				{
-					free(temp);
-					return -2;
-				}
-				if(memcmp(buf+(i*blocksize), temp, blocksize) == 0)
-				{
-				//	printf("blocksize write ok i=%d!\n\r", i);
-				}
-				else
-				{
-					printf("blocksize write incorrect block#=%d!\n\r",i);
-					free(temp);
-					return -2;
-				}
-			}
-#endif
-			free(temp);
-	
-			buf += aligned_size;
-			offs += aligned_size;
-			count -= aligned_size;
+		if (raspi_read(old, blockaddr, blocksize) != blocksize) {
+			ret = -2;
+			goto out;
+		}
+		if (memcmp(block, old, blocksize) != 0) {
+			printf("block write incorrect at %x!\n\r", blockaddr);
+			ret = -2;
+			goto out;
 		}
+#endif
+next:
+		buf += piece_size;
+		offs += piece_size;
+		count -= piece_size;
 	}
-	printf("Done!\n");
-	return 0;
+#undef UNIT_DIRTY
+#undef UNIT_CHANGED
+	printf("Done! %d sectors: %d unchanged, %d written without erase, %d kB erased\n",
+			total, same, noerase, erased >> 10);
+out:
+	free(old);
+	free(block);
+	return ret;
 }
 
 
@@ -732,7 +1114,7 @@ int do_mem_cp(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 		return 1;
 	}
 	
-	raspi_write((char *)addr, dest, count);
+	raspi_write((char *)(ulong)addr, dest, count);
 	return 0;
 }
 
@@ -789,6 +1171,153 @@ U_BOOT_CMD(
 	"erase linux\n    - erase linux kernel block\n"
 );
 
+#ifdef RT2880_U_BOOT_CMD_OPEN
+extern unsigned long mips_cpu_feq;
+
+static void spi_bench_run(int fast, unsigned int offs, int len, int count)
+{
+	ulong tick_per_us = (mips_cpu_feq / 2) / 1000000;
+	ulong t, best = ~0UL, us;
+	int i;
+
+	raspi_read_mode(fast);
+	for (i = 0; i < count; i++) {
+		t = get_timer(0);
+		raspi_read((char *)CFG_LOAD_ADDR, offs, len);
+		t = get_timer(t);
+		if (t < best)
+			best = t;
+	}
+	us = best / tick_per_us;
+	if (us == 0)
+		us = 1;
+	printf("\n   %-9s %3lu MHz %8lu us  %4lu.%lu MB/s\n",
+		(spi_read_op == OPCODE_FAST_READ) ? "FAST_READ" : "READ",
+		mips_bus_feq / (2 << (ra_inl(RT2880_SPICFG_REG) & 0x7)) / 1000 / 1000,
+		us, len / us, ((len % us) * 10) / us);
+}
+
+/*
+ * Time one planned raspi_erase() and compare it with the typical time
+ * of erasing the same range one sector at a time.
+ */
+static void spi_bench_erase(unsigned int offs, int len)
+{
+	struct spi_erase *e = spi_chip_info->erase;
+	ulong tick_per_ms = (mips_cpu_feq / 2) / 1000;
+	ulong t, sectors;
+	int k;
+
+	sectors = ((offs + len + spi_chip_info->sector_size - 1) / spi_chip_info->sector_size) -
+		offs / spi_chip_info->sector_size;
+	t = get_timer(0);
+	if (raspi_erase(offs, len) != 0) {
+		printf("erase failed\n");
+		return;
+	}
+	t = get_timer(t);
+
+	printf("   planned:");
+	for (k = 0; k < SPI_ERASE_TYPES && e[k].size; k++)
+		printf(" %d x %lu kB", spi_erase_count[k], (ulong)e[k].size >> 10);
+	if (spi_erase_count[SPI_ERASE_TYPES])
+		printf(" + chip erase");
+	printf(", %lu ms\n", t / tick_per_ms);
+	for (k = 0; k + 1 < SPI_ERASE_TYPES && e[k + 1].size; k++)
+		;
+	printf("   per sector: %lu x %lu kB, typically %lu ms\n",
+		sectors, spi_chip_info->sector_size >> 10, sectors * e[k].ms);
+}
+
+/*
+ * Time one raspi_write() of the load address to an already erased
+ * range; with no erase in the way this is the page program rate.
+ */
+static void spi_bench_write(unsigned int offs, int len)
+{
+	ulong tick_per_us = (mips_cpu_feq / 2) / 1000000;
+	ulong pages = (len + spi_chip_info->page_size - 1) / spi_chip_info->page_size;
+	ulong t, us, ms;
+
+	t = get_timer(0);
+	if (raspi_write((char *)CFG_LOAD_ADDR, offs, len) != len) {
+		printf("write failed\n");
+		return;
+	}
+	t = get_timer(t);
+	us = t / tick_per_us;
+	ms = (us < 1000) ? 1 : us / 1000;
+	printf("   %lu pages of %lu bytes, %lu us per page, %lu kB/s\n",
+		pages, (ulong)spi_chip_info->page_size, us / pages,
+		((ulong)len >> 10) * 1000 / ms);
+}
+
+/*
+ * Syntax:
+ *	spibench {offset} {len} [count]
+ *	spibench erase {offset} {len}
+ *	spibench write {offset} {len}
+ */
+int do_spi_bench(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	unsigned int offs;
+	int len, count = 3;
+
+	if (argc == 4 && (strcmp(argv[1], "erase") == 0 ||
+	    strcmp(argv[1], "write") == 0)) {
+		offs = simple_strtoul(argv[2], NULL, 16);
+		len = simple_strtoul(argv[3], NULL, 16);
+		if (len <= 0 ||
+		    offs + len > spi_chip_info->sector_size * spi_chip_info->n_sectors) {
+			printf("Usage:\n%s\n", cmdtp->usage);
+			return 1;
+		}
+		if (argv[1][0] == 'e')
+			spi_bench_erase(offs, len);
+		else
+			spi_bench_write(offs, len);
+		return 0;
+	}
+	if (argc < 3) {
+		printf("Usage:\n%s\n", cmdtp->usage);
+		return 1;
+	}
+	offs = simple_strtoul(argv[1], NULL, 16);
+	len = simple_strtoul(argv[2], NULL, 16);
+	if (argc > 3)
+		count = simple_strtoul(argv[3], NULL, 10);
+	if (len <= 0 || count <= 0 ||
+	    offs + len > spi_chip_info->sector_size * spi_chip_info->n_sectors) {
+		printf("Usage:\n%s\n", cmdtp->usage);
+		return 1;
+	}
+
+#ifdef CFG_SPI_MMAP_SIZE
+	printf("   mmap window: %lu kB\n", (ulong)spi_mmap_len >> 10);
+#endif
+	spi_bench_run(0, offs, len, count);
+	if (spi_chip_info->fast_mhz)
+		spi_bench_run(1, offs, len, count);
+	/* leave the fastest mode the chip has selected */
+	raspi_read_mode(1);
+	return 0;
+}
+
+U_BOOT_CMD(
+	spibench,	4,	0,	do_spi_bench,
+	"spibench - SPI flash read, erase and program throughput\n",
+	"offset len [count]\n"
+	"    - read len bytes at flash offset to the load address count\n"
+	"      times (default 3) in each read mode, print the best MB/s\n"
+	"spibench erase offset len\n"
+	"    - erase the range with the erase planner and print its time\n"
+	"      next to the typical time of a sector by sector erase\n"
+	"spibench write offset len\n"
+	"    - program len bytes from the load address to an erased range\n"
+	"      and print the time per page\n"
+);
+#endif
+
 //#define SPI_FLASH_DBG_CMD 
 #ifdef SPI_FLASH_DBG_CMD
 int ralink_spi_command(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
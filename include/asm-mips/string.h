@@ -122,13 +122,14 @@ strncmp(__const__ char *__cs, __const__ char *__ct, size_t __count)
 	return __res;
 }
 
-#undef __HAVE_ARCH_MEMSET
+/* word-wide, prefetching versions in lib_mips/memcpy.S */
+#define __HAVE_ARCH_MEMSET
 extern void *memset(void *__s, int __c, size_t __count);
 
-#undef __HAVE_ARCH_MEMCPY
+#define __HAVE_ARCH_MEMCPY
 extern void *memcpy(void *__to, __const__ void *__from, size_t __n);
 
-#undef __HAVE_ARCH_MEMMOVE
+#define __HAVE_ARCH_MEMMOVE
 extern void *memmove(void *__dest, __const__ void *__src, size_t __n);
 
 /* Don't build bcopy at all ...  */
@@ -228,6 +228,14 @@ int	autoscript (ulong addr);
 /* common/cmd_bootm.c */
 void	print_image_hdr (image_header_t *hdr);
 
+/* common/image_verify.c */
+int	image_verify_cached (ulong addr, ulong hcrc, ulong size);
+void	image_verify_record (ulong addr, ulong hcrc, ulong size);
+int	flash_gen_bump (ulong addr, ulong len);
+
+/* common/image_chunk.c */
+int	chunked_image_load (ulong addr, image_header_t *hdr, ulong *lenp);
+
 extern ulong load_addr;		/* Default Load Address */
 
 /* common/cmd_nvedit.c */
@@ -530,6 +538,8 @@ ulong	video_setmem (ulong);
 
 /* lib_$(ARCH)/cache.c */
 void	flush_cache   (unsigned long, unsigned long);
+void	flush_dcache_range (unsigned long, unsigned long);
+void	invalidate_dcache_range (unsigned long, unsigned long);
 
 
 /* lib_$(ARCH)/ticks.S */
@@ -130,6 +130,8 @@
 #define	CFG_MAXARGS		16		/* max number of command args*/
 
 #define CFG_MALLOC_LEN		256*1024
+#define CFG_ARENA_LEN		128*1024	/* decompressor state, below the heap */
+/* #define CFG_MALLOC_TRACE */			/* per call site malloc() statistics */
 
 #define CFG_BOOTPARAMS_LEN	128*1024
 
@@ -269,6 +271,14 @@
 #define CFG_FLASH2_BASE		PHYS_FLASH2_1
 #endif
 
+/*
+ * Booting from SPI flash leaves it mapped at CFG_FLASH_BASE with 3-byte
+ * addressing; raspi_read() uses that window once it has checked it.
+ */
+#if defined (CFG_ENV_IS_IN_SPI)
+#define CFG_SPI_MMAP_SIZE	0x1000000
+#endif
+
 /* timeout values are in ticks */
 #define CFG_FLASH_ERASE_TOUT	(15UL * CFG_HZ) /* Timeout for Flash Erase */
 #define CFG_FLASH_WRITE_TOUT	(5 * CFG_HZ) /* Timeout for Flash Write */
@@ -386,6 +396,8 @@
 #define CONFIG_SYS_USB_OHCI_SLOT_NAME		"rt3680"
 #define CONFIG_USB_EHCI		1
 #define CONFIG_USB_STORAGE    1
+#define CFG_EHCI_QTD_NUM	3	/* qTDs per EHCI transfer */
+#define CFG_OHCI_TD_NUM		64	/* OHCI TDs in flight */
 #define CONFIG_DOS_PARTITION
 #define LITTLEENDIAN
 #define CONFIG_CRC32_VERIFY
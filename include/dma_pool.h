@@ -0,0 +1,26 @@
+#ifndef _DMA_POOL_H_
+#define _DMA_POOL_H_
+
+/*
+ * Pool of fixed size, cache line aligned blocks for DMA descriptors and
+ * buffers.  Blocks are handed out through KSEG1, so neither the CPU nor
+ * the device ever sees a stale cache line.
+ */
+struct dma_pool {
+	const char	*name;
+	ulong		size;		/* block size, rounded to the line size */
+	ulong		count;		/* number of blocks */
+	uchar		*mem;		/* backing store from malloc() */
+	void		*free;		/* free list, linked through the blocks */
+	ulong		in_use;
+	ulong		peak;
+	ulong		allocs;
+	ulong		fails;
+	struct dma_pool	*next;		/* list of all pools, for "dmapool" */
+};
+
+int	dma_pool_init (struct dma_pool *pool, const char *name, size_t size, int count);
+void	*dma_pool_alloc (struct dma_pool *pool);
+void	dma_pool_free (struct dma_pool *pool, void *p);
+
+#endif
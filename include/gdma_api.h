@@ -0,0 +1,18 @@
+#ifndef _GDMA_API_H_
+#define _GDMA_API_H_
+
+/* copies shorter than this are not worth the cache maintenance */
+#define GDMA_MIN_LEN		4096
+
+void *dma_memcpy(void *dst, const void *src, size_t len);
+void *dma_memset(void *dst, int c, size_t len);
+
+/* DMA request lines of peripheral FIFOs */
+#define GDMA_REQ_NAND		1
+
+int dma_dev_read(void *dst, ulong fifo, int req, ulong len);
+int dma_dev_read_split(void *dst, ulong len, void *tail, ulong tail_len,
+		ulong fifo, int req);
+int dma_dev_wait(void);
+
+#endif
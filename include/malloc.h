@@ -907,7 +907,7 @@ extern Void_t*     sbrk();
 
 #if __STD_C
 
-Void_t* mALLOc(size_t);
+Void_t* (mALLOc)(size_t);	/* in parentheses: see CFG_MALLOC_TRACE below */
 void    fREe(Void_t*);
 Void_t* rEALLOc(Void_t*, size_t);
 Void_t* mEMALIGn(size_t, size_t);
@@ -921,7 +921,7 @@ void    malloc_stats(void);
 int     mALLOPt(int, int);
 struct mallinfo mALLINFo(void);
 #else
-Void_t* mALLOc();
+Void_t* (mALLOc)();
 void    fREe();
 Void_t* rEALLOc();
 Void_t* mEMALIGn();
@@ -936,6 +936,31 @@ int     mALLOPt();
 struct mallinfo mALLINFo();
 #endif
 
+/* heap usage accounting, see common/dlmalloc.c */
+unsigned long malloc_usage(unsigned long *peak);
+void	malloc_peak_reset(void);
+unsigned long malloc_max_usage(void);
+unsigned long malloc_free_stats(unsigned long *total, unsigned long *chunks);
+
+/* bump arena for large temporary buffers, see common/dlmalloc.c */
+void	arena_init(unsigned long start, unsigned long len);
+void	*arena_alloc(size_t bytes);
+void	arena_free(void *mem);
+unsigned long arena_mark(void);
+void	arena_release(unsigned long mark);
+unsigned long arena_usage(unsigned long *peak, unsigned long *fallbacks);
+void	arena_peak_reset(void);
+
+/*
+ * With CFG_MALLOC_TRACE every malloc() call site that sees this header
+ * after the board config is recorded; "meminfo" prints the table.
+ */
+#if defined(CFG_MALLOC_TRACE) && !defined(MALLOC_TRACE_IMPL)
+void	*malloc_trace(size_t bytes, const char *file, int line);
+#define malloc(n)	malloc_trace((n), __FILE__, __LINE__)
+#endif
+void	malloc_trace_print(void);
+
 
 #ifdef __cplusplus
 };  /* end of extern "C" */
@@ -20,6 +20,19 @@
 #include <linux/ctype.h>
 #include <malloc.h>
 
+/* word size and mask used by the word-at-a-time fallbacks below */
+#define WSIZE	sizeof(unsigned long)
+#define WMASK	(WSIZE - 1)
+
+/*
+ * HASZERO(x) is non-zero iff one of the bytes of word x is zero.  Aligned
+ * word loads never cross a page, so reading the rest of the word that
+ * holds a terminator is harmless.
+ */
+#define ONES		(~0UL / 0xff)
+#define HIGHS		(ONES << 7)
+#define HASZERO(x)	(((x) - ONES) & ~(x) & HIGHS)
+
 
 #ifndef __HAVE_ARCH_STRNICMP
 /**
@@ -150,14 +163,19 @@ char * strncat(char *dest, const char *src, size_t count)
  */
 int strcmp(const char * cs,const char * ct)
 {
-	register signed char __res;
+	unsigned char c1, c2;
 
+	/* bytes compare as unsigned char, as in the C library */
 	while (1) {
-		if ((__res = *cs - *ct++) != 0 || !*cs++)
+		c1 = *cs++;
+		c2 = *ct++;
+		if (c1 != c2)
+			return c1 < c2 ? -1 : 1;
+		if (!c1)
 			break;
 	}
 
-	return __res;
+	return 0;
 }
 #endif
 
@@ -170,15 +188,19 @@ int strcmp(const char * cs,const char * ct)
  */
 int strncmp(const char * cs,const char * ct,size_t count)
 {
-	register signed char __res = 0;
+	unsigned char c1, c2;
 
 	while (count) {
-		if ((__res = *cs - *ct++) != 0 || !*cs++)
+		c1 = *cs++;
+		c2 = *ct++;
+		if (c1 != c2)
+			return c1 < c2 ? -1 : 1;
+		if (!c1)
 			break;
 		count--;
 	}
 
-	return __res;
+	return 0;
 }
 #endif
 
@@ -222,8 +244,14 @@ char * strrchr(const char * s, int c)
 size_t strlen(const char * s)
 {
 	const char *sc;
+	const unsigned long *wp;
 
-	for (sc = s; *sc != '\0'; ++sc)
+	for (sc = s; (unsigned long)sc & WMASK; ++sc)
+		if (*sc == '\0')
+			return sc - s;
+	for (wp = (const unsigned long *)sc; !HASZERO(*wp); ++wp)
+		/* nothing */;
+	for (sc = (const char *)wp; *sc != '\0'; ++sc)
 		/* nothing */;
 	return sc - s;
 }
@@ -238,8 +266,14 @@ size_t strlen(const char * s)
 size_t strnlen(const char * s, size_t count)
 {
 	const char *sc;
-
-	for (sc = s; count-- && *sc != '\0'; ++sc)
+	const unsigned long *wp;
+
+	for (sc = s; count && ((unsigned long)sc & WMASK); ++sc, count--)
+		if (*sc == '\0')
+			return sc - s;
+	for (wp = (const unsigned long *)sc; count >= WSIZE && !HASZERO(*wp); ++wp)
+		count -= WSIZE;
+	for (sc = (const char *)wp; count-- && *sc != '\0'; ++sc)
 		/* nothing */;
 	return sc - s;
 }
@@ -403,6 +437,25 @@ char *strswab(const char *s)
 void * memset(void * s,int c,size_t count)
 {
 	char *xs = (char *) s;
+	unsigned long *sl, pattern;
+
+	if (count >= 2 * WSIZE) {
+		while ((unsigned long)xs & WMASK) {
+			*xs++ = c;
+			count--;
+		}
+		pattern = (unsigned char)c;
+		pattern |= pattern << 8;
+		pattern |= pattern << 16;
+		if (WSIZE > 4)
+			pattern |= (pattern << 16) << 16;
+		sl = (unsigned long *)xs;
+		while (count >= WSIZE) {
+			*sl++ = pattern;
+			count -= WSIZE;
+		}
+		xs = (char *)sl;
+	}
 
 	while (count--)
 		*xs++ = c;
@@ -448,6 +501,23 @@ char * bcopy(const char * src, char * dest, int count)
 void * memcpy(void * dest,const void *src,size_t count)
 {
 	char *tmp = (char *) dest, *s = (char *) src;
+	unsigned long *dl, *sl;
+
+	/* go a word at a time once both pointers can be aligned together */
+	if (count >= 2 * WSIZE && (((unsigned long)tmp ^ (unsigned long)s) & WMASK) == 0) {
+		while ((unsigned long)tmp & WMASK) {
+			*tmp++ = *s++;
+			count--;
+		}
+		dl = (unsigned long *)tmp;
+		sl = (unsigned long *)s;
+		while (count >= WSIZE) {
+			*dl++ = *sl++;
+			count -= WSIZE;
+		}
+		tmp = (char *)dl;
+		s = (char *)sl;
+	}
 
 	while (count--)
 		*tmp++ = *s++;
@@ -468,16 +538,45 @@ void * memcpy(void * dest,const void *src,size_t count)
 void * memmove(void * dest,const void *src,size_t count)
 {
 	char *tmp, *s;
+	unsigned long *dl, *sl;
 
 	if (dest <= src) {
 		tmp = (char *) dest;
 		s = (char *) src;
+		if (count >= 2 * WSIZE && (((unsigned long)tmp ^ (unsigned long)s) & WMASK) == 0) {
+			while ((unsigned long)tmp & WMASK) {
+				*tmp++ = *s++;
+				count--;
+			}
+			dl = (unsigned long *)tmp;
+			sl = (unsigned long *)s;
+			while (count >= WSIZE) {
+				*dl++ = *sl++;
+				count -= WSIZE;
+			}
+			tmp = (char *)dl;
+			s = (char *)sl;
+		}
 		while (count--)
 			*tmp++ = *s++;
 		}
 	else {
 		tmp = (char *) dest + count;
 		s = (char *) src + count;
+		if (count >= 2 * WSIZE && (((unsigned long)tmp ^ (unsigned long)s) & WMASK) == 0) {
+			while ((unsigned long)tmp & WMASK) {
+				*--tmp = *--s;
+				count--;
+			}
+			dl = (unsigned long *)tmp;
+			sl = (unsigned long *)s;
+			while (count >= WSIZE) {
+				*--dl = *--sl;
+				count -= WSIZE;
+			}
+			tmp = (char *)dl;
+			s = (char *)sl;
+		}
 		while (count--)
 			*--tmp = *--s;
 		}
@@ -495,10 +594,27 @@ void * memmove(void * dest,const void *src,size_t count)
  */
 int memcmp(const void * cs,const void * ct,size_t count)
 {
-	const unsigned char *su1, *su2;
+	const unsigned char *su1 = cs, *su2 = ct;
+	const unsigned long *w1, *w2;
 	int res = 0;
 
-	for( su1 = cs, su2 = ct; 0 < count; ++su1, ++su2, count--)
+	/* skip equal words, the byte loop then finds the first difference */
+	if (count >= 2 * WSIZE && (((unsigned long)su1 ^ (unsigned long)su2) & WMASK) == 0) {
+		for (; (unsigned long)su1 & WMASK; ++su1, ++su2, count--)
+			if ((res = *su1 - *su2) != 0)
+				return res;
+		w1 = (const unsigned long *)su1;
+		w2 = (const unsigned long *)su2;
+		while (count >= WSIZE && *w1 == *w2) {
+			w1++;
+			w2++;
+			count -= WSIZE;
+		}
+		su1 = (const unsigned char *)w1;
+		su2 = (const unsigned char *)w2;
+	}
+
+	for( ; 0 < count; ++su1, ++su2, count--)
 		if ((res = *su1 - *su2) != 0)
 			break;
 	return res;
@@ -566,6 +682,23 @@ char * strstr(const char * s1,const char * s2)
 void *memchr(const void *s, int c, size_t n)
 {
 	const unsigned char *p = s;
+	const unsigned long *wp;
+	unsigned long pattern, w;
+
+	if (n >= 2 * WSIZE) {
+		for (; (unsigned long)p & WMASK; n--)
+			if ((unsigned char)c == *p++)
+				return (void *)(p-1);
+		pattern = (unsigned char)c * ONES;
+		for (wp = (const unsigned long *)p; n >= WSIZE; ++wp) {
+			w = *wp ^ pattern;
+			if (HASZERO(w))
+				break;
+			n -= WSIZE;
+		}
+		p = (const unsigned char *)wp;
+	}
+
 	while (n-- != 0) {
 		if ((unsigned char)c == *p++) {
 			return (void *)(p-1);
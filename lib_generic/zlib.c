@@ -863,7 +863,7 @@ int r;
       break;
     case LENS:
       NEEDBITS(32)
-      if (((~b) >> 16) != (b & 0xffff))
+      if ((((~b) >> 16) & 0xffff) != (b & 0xffff))
       {
 	s->mode = BADB;
 	z->msg = "invalid stored block lengths";
@@ -1948,6 +1948,11 @@ int r;
 #define GRABBITS(j) {while(k<(j)){b|=((uLong)NEXTBYTE)<<k;k+=8;}}
 #define UNGRAB {n+=(c=k>>3);p-=c;k&=7;}
 
+/* Unaligned 32-bit load/store; gcc emits lwl/lwr and swl/swr for these
+   on MIPS, so match copies move a word per step instead of a byte. */
+typedef struct { uInt w; } __attribute__ ((packed)) unaligned_word;
+#define COPYWORD(d,s) (((unaligned_word *)(d))->w = ((unaligned_word *)(s))->w)
+
 /* Called with number of bytes left to write in window at least 258
    (the maximum string length) and number of input bytes available
    at least ten.  The ten bytes are six bytes for the longest length/
@@ -2023,8 +2028,21 @@ z_stream *z;
 	    if ((uInt)(q - s->window) >= d)     /* offset before dest */
 	    {                                   /*  just copy */
 	      r = q - d;
-	      *q++ = *r++;  c--;        /* minimum count is three, */
-	      *q++ = *r++;  c--;        /*  so unroll loop a little */
+	      if (d >= 4)               /* words never overlap, go wide */
+	      {
+		while (c >= 4)
+		{
+		  COPYWORD(q, r);
+		  q += 4;  r += 4;  c -= 4;
+		}
+		if (c == 0)
+		  break;
+	      }
+	      else
+	      {
+		*q++ = *r++;  c--;      /* minimum count is three, */
+		*q++ = *r++;  c--;      /*  so unroll loop a little */
+	      }
 	    }
 	    else                        /* else offset after destination */
 	    {
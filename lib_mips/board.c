@@ -32,6 +32,7 @@
 #include <rt_mmap.h>
 #include <spi_api.h>
 #include <nand_api.h>
+#include <gdma_api.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 #undef DEBUG
@@ -51,6 +52,11 @@ int modifies= 0;
 #else
 #define	TOTAL_MALLOC_LEN	CFG_MALLOC_LEN
 #endif
+#ifdef CFG_ARENA_LEN
+#define	TOTAL_ARENA_LEN		CFG_ARENA_LEN
+#else
+#define	TOTAL_ARENA_LEN		0
+#endif
 #define ARGV_LEN  128
 
 
@@ -339,7 +345,8 @@ static void Init_System_Mode(void)
 
 
 /*
- * The Malloc area is immediately below the monitor copy in DRAM
+ * The Malloc area is immediately below the monitor copy in DRAM,
+ * the temporary buffer arena immediately below that
  */
 static void mem_malloc_init (void)
 {
@@ -353,6 +360,9 @@ static void mem_malloc_init (void)
 	memset ((void *) mem_malloc_start,
 		0,
 		mem_malloc_end - mem_malloc_start);
+
+	if (TOTAL_ARENA_LEN)
+		arena_init (mem_malloc_start - TOTAL_ARENA_LEN, TOTAL_ARENA_LEN);
 }
 
 void *sbrk (ptrdiff_t increment)
@@ -571,6 +581,7 @@ void board_init_f(ulong bootflag)
 	debug ("Reserving %dk for malloc() at: %08lx\n",
 			TOTAL_MALLOC_LEN >> 10, addr_sp);
 #endif
+	addr_sp -= TOTAL_ARENA_LEN;
 	/*
 	 * (permanently) allocate a Board Info struct
 	 * and a permanent copy of the "global" data
@@ -832,10 +843,9 @@ int copy_image(int dir, unsigned long image_size)
 		e_end = CFG_KERN2_ADDR + image_size - 1;
 		if (get_addr_boundary(&e_end) != 0)
 			return -1;
-		printf("Erase from 0x%X to 0x%X\n", CFG_KERN2_ADDR, e_end);
-		flash_sect_erase(CFG_KERN2_ADDR, e_end);
-		memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN_ADDR, image_size);
-		ret = flash_write((uchar *)CFG_LOAD_ADDR, (ulong)CFG_KERN2_ADDR, image_size);
+		printf("Write from 0x%X to 0x%X\n", CFG_KERN2_ADDR, e_end);
+		dma_memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN_ADDR, image_size);
+		ret = flash_erase_write((uchar *)CFG_LOAD_ADDR, (ulong)CFG_KERN2_ADDR, image_size);
 #endif
 	}
 	else if (dir == 2) {
@@ -861,7 +871,7 @@ int copy_image(int dir, unsigned long image_size)
 				return -1;
 		        printf("Erase from 0x%X To 0x%X\n", CFG_KERN_ADDR, e_end);
 			flash_sect_erase(CFG_KERN_ADDR, e_end);
-			memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN2_ADDR, image_size);
+			dma_memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN2_ADDR, image_size);
 			ret = flash_write((uchar *)CFG_LOAD_ADDR, (ulong)CFG_KERN_ADDR, image_size);
 		}
 		else {
@@ -875,7 +885,7 @@ int copy_image(int dir, unsigned long image_size)
 				return -1;
 	        	printf("From 0x%X To 0x%X\n", PHYS_FLASH_2, e_end);
 			flash_sect_erase(PHYS_FLASH_2, e_end);
-			memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN2_ADDR, image_size);
+			dma_memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN2_ADDR, image_size);
 			ret = flash_write((uchar *)CFG_LOAD_ADDR, (ulong)CFG_KERN_ADDR, len);
 			ret = flash_write((uchar *)(CFG_LOAD_ADDR + len), (ulong)PHYS_FLASH_2, image_size - len);
 		}
@@ -883,10 +893,9 @@ int copy_image(int dir, unsigned long image_size)
 		e_end = CFG_KERN_ADDR + image_size - 1;
 		if (get_addr_boundary(&e_end) != 0)
 			return -1;
-		printf("Erase from 0x%X to 0x%X\n", CFG_KERN_ADDR, e_end);
-		flash_sect_erase(CFG_KERN_ADDR, e_end);
-		memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN2_ADDR, image_size);
-		ret = flash_write((uchar *)CFG_LOAD_ADDR, (ulong)CFG_KERN_ADDR, image_size);
+		printf("Write from 0x%X to 0x%X\n", CFG_KERN_ADDR, e_end);
+		dma_memcpy(CFG_LOAD_ADDR, (void *)CFG_KERN2_ADDR, image_size);
+		ret = flash_erase_write((uchar *)CFG_LOAD_ADDR, (ulong)CFG_KERN_ADDR, image_size);
 #endif
 #endif
 		if (ret == 0) {
@@ -914,7 +923,7 @@ int check_image_validation(void)
 {
 	int ret = 0;
 	int broken1 = 0, broken2 = 0;
-	unsigned long len = 0, chksum = 0;
+	unsigned long len = 0, chksum = 0, hcrc1 = 0, hcrc2 = 0;
 	image_header_t hdr1, hdr2;
 	unsigned char *hdr1_addr, *hdr2_addr;
 	char *stable, *try;
@@ -924,7 +933,7 @@ int check_image_validation(void)
 	
 #if defined (CFG_ENV_IS_IN_NAND)
 	ranand_read((char *)&hdr1, (unsigned int)hdr1_addr - CFG_FLASH_BASE, sizeof(image_header_t));
-	ranand_read(char *)(&hdr2, (unsigned int)hdr2_addr - CFG_FLASH_BASE, sizeof(image_header_t));
+	ranand_read((char *)&hdr2, (unsigned int)hdr2_addr - CFG_FLASH_BASE, sizeof(image_header_t));
 #elif defined (CFG_ENV_IS_IN_SPI)
 	raspi_read((char *)&hdr1, (unsigned int)hdr1_addr - CFG_FLASH_BASE, sizeof(image_header_t));
 	raspi_read((char *)&hdr2, (unsigned int)hdr2_addr - CFG_FLASH_BASE, sizeof(image_header_t));
@@ -958,7 +967,7 @@ int check_image_validation(void)
 	if (broken1 == 0) {
 		printf("Image1 Header Checksum --> ");
 		len  = sizeof(image_header_t);
-		chksum = ntohl(hdr1.ih_hcrc);
+		chksum = hcrc1 = ntohl(hdr1.ih_hcrc);
 		hdr1.ih_hcrc = 0;
 		if (crc32(0, (char *)&hdr1, len) != chksum) {
 			broken1 = 1;
@@ -971,7 +980,7 @@ int check_image_validation(void)
 	if (broken2 == 0) {
 		printf("Image2 Header Checksum --> ");
 		len  = sizeof(image_header_t);
-		chksum = ntohl(hdr2.ih_hcrc);
+		chksum = hcrc2 = ntohl(hdr2.ih_hcrc);
 		hdr2.ih_hcrc = 0;
 		if (crc32(0, (char *)&hdr2, len) != chksum) {
 			printf("Failed\n");
@@ -983,7 +992,9 @@ int check_image_validation(void)
 
 	/* Check data crc */
 	/* Skip crc checking if there is no valid header, or it may hang on due to broken data length */
-	if (broken1 == 0) {
+	if (broken1 == 0 && image_verify_cached((ulong)hdr1_addr, hcrc1, ntohl(hdr1.ih_size)))
+		printf("Image1 Data Checksum --> OK (cached)\n");
+	else if (broken1 == 0) {
 		printf("Image1 Data Checksum --> ");
 		len = ntohl(hdr1.ih_size);
 		chksum = ntohl(hdr1.ih_dcrc);
@@ -1004,11 +1015,15 @@ int check_image_validation(void)
 			broken1 = 1;
 			printf("Failed\n");
 		}
-		else
+		else {
 			printf("OK\n");
+			image_verify_record((ulong)hdr1_addr, hcrc1, len);
+		}
 	}
 
-	if (broken2 == 0) {
+	if (broken2 == 0 && image_verify_cached((ulong)hdr2_addr, hcrc2, ntohl(hdr2.ih_size)))
+		printf("Image2 Data Checksum --> OK (cached)\n");
+	else if (broken2 == 0) {
 		printf("Image2 Data Checksum --> ");
 		len  = ntohl(hdr2.ih_size);
 		chksum = ntohl(hdr2.ih_dcrc);
@@ -1029,8 +1044,10 @@ int check_image_validation(void)
 			broken2 = 1;
 			printf("Failed\n");
 		}
-		else
+		else {
 			printf("OK\n");
+			image_verify_record((ulong)hdr2_addr, hcrc2, len);
+		}
 	}
 
 	/* Check stable flag and try counter */
@@ -108,7 +108,9 @@ void do_bootm_linux (cmd_tbl_t * cmdtp, int flag, int argc, char *argv[],
 		data = addr + sizeof (image_header_t);
 		len = ntohl (hdr->ih_size);
 
-		if (verify) {
+		if (verify && image_verify_cached (addr, checksum, len)) {
+			printf ("   Verifying Checksum ... OK (cached)\n");
+		} else if (verify) {
 			ulong csum = 0;
 
 			printf ("   Verifying Checksum ... ");
@@ -119,6 +121,7 @@ void do_bootm_linux (cmd_tbl_t * cmdtp, int flag, int argc, char *argv[],
 				do_reset (cmdtp, flag, argc, argv);
 			}
 			printf ("OK\n");
+			image_verify_record (addr, checksum, len);
 		}
 
 		SHOW_BOOT_PROGRESS (11);
@@ -150,6 +150,9 @@ int nand_read(uint32_t dst, uint32_t addr, uint32_t size)
 	long p = dst;
 	unsigned int bus_addr;
 	unsigned len;
+#ifdef CONFIG_BADBLOCK_CHECK
+	uint32_t good = ~0;	/* last block found good, checked once */
+#endif
 
 	ra_outl(NFC_INT_ST, ra_inl(NFC_INT_ST));
 
@@ -157,9 +160,12 @@ int nand_read(uint32_t dst, uint32_t addr, uint32_t size)
 		bus_addr = ((addr >> PAGE_SIZE) << (COLUMN_ADDR_CYCLE*8));
 
 #ifdef CONFIG_BADBLOCK_CHECK
-		if (nand_block_isbad(addr)) {
-			addr += 0x4000;
-			continue;
+		if ((addr >> 14) != good) {
+			if (nand_block_isbad(addr)) {
+				addr += 0x4000;
+				continue;
+			}
+			good = addr >> 14;
 		}
 #endif
 
@@ -124,6 +124,7 @@
 #define IH_COMP_GZIP		1	/* gzip	 Compression Used	*/
 #define IH_COMP_BZIP2		2	/* bzip2 Compression Used	*/
 #define IH_COMP_LZMA		3	/* lzma  Compression Used	*/
+#define IH_COMP_CHUNKED		0x80	/* flag: chunked image, see below */
 
 #define IH_MAGIC	0x27051956	/* Image Magic Number		*/
 #define IH_NMLEN		16	/* Image Name Length		*/
@@ -170,5 +171,30 @@ typedef struct image_header {
 	dram_header_t   ih_dram;
 } image_header_t;
 
+/*
+ * Chunked images (IH_COMP_CHUNKED set in ih_comp): the data part starts
+ * with a chunk index, followed by the chunks.  Each chunk is compressed
+ * on its own with (ih_comp & ~IH_COMP_CHUNKED) and padded to a word
+ * boundary; chunk i uncompresses to ci_chunk_size bytes (the last one
+ * may be shorter) at ih_load + i * ci_chunk_size.  ih_dcrc still covers
+ * the whole data part, index included.
+ */
+#define IH_CHUNK_MAGIC	0x43484e4b	/* Chunk Index Magic ("CHNK")	*/
+
+typedef struct chunk_entry {
+	uint32_t	ce_offset;	/* Chunk Offset in Data Part	*/
+	uint32_t	ce_len;		/* Compressed Chunk Length	*/
+	uint32_t	ce_crc;		/* Compressed Chunk CRC		*/
+} chunk_entry_t;
+
+typedef struct chunk_index {
+	uint32_t	ci_magic;	/* Chunk Index Magic Number	*/
+	uint32_t	ci_crc;		/* Index CRC (entries included)	*/
+	uint32_t	ci_chunk_size;	/* Uncompressed Chunk Size	*/
+	uint32_t	ci_count;	/* Number of Chunks		*/
+	uint32_t	ci_size;	/* Total Uncompressed Size	*/
+	chunk_entry_t	ci_entry[0];	/* ci_count entries follow	*/
+} chunk_index_t;
+
 
 #endif	/* __IMAGE_H__ */
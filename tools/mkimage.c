@@ -140,6 +140,7 @@ table_entry_t comp_name[] = {
 };
 
 static	void	copy_file (int, const char *, int);
+static	void	copy_file_chunked (int, const char *);
 static	void	usage	(void);
 static	void	print_header (image_header_t *);
 static	void	print_type (image_header_t *);
@@ -158,6 +159,7 @@ static	int	get_type(char *);
 char	*datafile;
 char	*imagefile;
 
+int cflag    = 0;
 int dflag    = 0;
 int eflag    = 0;
 int lflag    = 0;
@@ -167,6 +169,7 @@ int opt_os   = IH_OS_LINUX;
 int opt_arch = IH_CPU_PPC;
 int opt_type = IH_TYPE_KERNEL;
 int opt_comp = IH_COMP_GZIP;
+uint32_t opt_chunk = 0;
 
 image_header_t header;
 image_header_t *hdr = &header;
@@ -231,6 +234,18 @@ main (int argc, char **argv)
 					exit (EXIT_FAILURE);
 				}
 				goto NXTARG;
+			case 'c':
+				if (--argc <= 0)
+					usage ();
+				opt_chunk = strtoul (*++argv, (char **)&ptr, 16);
+				if (*ptr || opt_chunk == 0) {
+					fprintf (stderr,
+						"%s: invalid chunk size %s\n",
+						cmdname, *argv);
+					exit (EXIT_FAILURE);
+				}
+				cflag = 1;
+				goto NXTARG;
 			case 'd':
 				if (--argc <= 0)
 					usage ();
@@ -384,6 +399,13 @@ NXTARG:		;
 	if ((argc != 1) || ((lflag ^ dflag) == 0))
 		usage();
 
+	if (cflag && (xflag || opt_type == IH_TYPE_MULTI ||
+		      opt_type == IH_TYPE_SCRIPT)) {
+		fprintf (stderr, "%s: -c can't be used with -x or multi-file images\n",
+			cmdname);
+		exit (EXIT_FAILURE);
+	}
+
 	if (!eflag) {
 		ep = addr;
 		/* If XIP, entry point must be after the U-Boot header */
@@ -556,6 +578,8 @@ NXTARG:		;
 				break;
 			}
 		}
+	} else if (cflag) {
+		copy_file_chunked (ifd, datafile);
 	} else {
 		copy_file (ifd, datafile, 0);
 	}
@@ -598,7 +622,7 @@ NXTARG:		;
 	hdr->ih_os    = opt_os;
 	hdr->ih_arch  = opt_arch;
 	hdr->ih_type  = opt_type;
-	hdr->ih_comp  = opt_comp;
+	hdr->ih_comp  = opt_comp | (cflag ? IH_COMP_CHUNKED : 0);
 
 	strncpy((char *)hdr->ih_name, name, IH_NMLEN);
 
@@ -737,18 +761,187 @@ copy_file (int ifd, const char *datafile, int pad)
 	(void) close (dfd);
 }
 
+/*
+ * Compress 'len' bytes at 'data' by running them through the external
+ * compressor for opt_comp; returns a malloc'ed buffer and its length.
+ */
+static unsigned char *
+compress_chunk (const unsigned char *data, int len, int *outlen)
+{
+	char tmpname[] = "/tmp/mkimageXXXXXX";
+	char cmd[64];
+	const char *prog;
+	unsigned char *out = NULL;
+	int size = 0, n, tfd;
+	FILE *fp;
+
+	switch (opt_comp) {
+	case IH_COMP_GZIP:	prog = "gzip -9 -n -c";		break;
+	case IH_COMP_BZIP2:	prog = "bzip2 -9 -c";		break;
+	case IH_COMP_LZMA:	prog = "lzma -9 -c";		break;
+	default:
+		fprintf (stderr, "%s: can't compress chunks as %s\n",
+			cmdname, put_comp (opt_comp));
+		exit (EXIT_FAILURE);
+	}
+
+	if ((tfd = mkstemp (tmpname)) < 0 ||
+	    write (tfd, data, len) != len) {
+		fprintf (stderr, "%s: Can't write %s: %s\n",
+			cmdname, tmpname, strerror(errno));
+		exit (EXIT_FAILURE);
+	}
+	close (tfd);
+
+	sprintf (cmd, "%s < %s", prog, tmpname);
+	if ((fp = popen (cmd, "r")) == NULL) {
+		fprintf (stderr, "%s: Can't run %s: %s\n",
+			cmdname, prog, strerror(errno));
+		exit (EXIT_FAILURE);
+	}
+	do {
+		if ((out = realloc (out, size + 65536)) == NULL) {
+			fprintf (stderr, "%s: out of memory\n", cmdname);
+			exit (EXIT_FAILURE);
+		}
+		n = fread (out + size, 1, 65536, fp);
+		size += n;
+	} while (n > 0);
+	if (pclose (fp) != 0 || size == 0) {
+		fprintf (stderr, "%s: %s failed\n", cmdname, prog);
+		exit (EXIT_FAILURE);
+	}
+	unlink (tmpname);
+
+	/*
+	 * lzma writes "size unknown" when reading a pipe, which the
+	 * target decoder refuses; fill in the real size (little endian).
+	 */
+	if (opt_comp == IH_COMP_LZMA && size >= 13) {
+		for (n = 0; n < 8; n++)
+			out[5 + n] = (n < 4) ? (len >> (n * 8)) & 0xff : 0;
+	}
+
+	*outlen = size;
+	return out;
+}
+
+/*
+ * Write 'datafile' as a chunk index followed by opt_chunk sized pieces,
+ * each compressed on its own (see chunk_index_t in image.h).
+ */
+static void
+copy_file_chunked (int ifd, const char *datafile)
+{
+	int dfd;
+	struct stat sbuf;
+	unsigned char *ptr, *out;
+	chunk_index_t *idx;
+	int i, n, isize, len, outlen;
+	uint32_t offset;
+	int zero = 0;
+
+	if (vflag) {
+		fprintf (stderr, "Adding Image %s in chunks of 0x%x\n",
+			datafile, opt_chunk);
+	}
+
+	if ((dfd = open(datafile, O_RDONLY|O_BINARY)) < 0) {
+		fprintf (stderr, "%s: Can't open %s: %s\n",
+			cmdname, datafile, strerror(errno));
+		exit (EXIT_FAILURE);
+	}
+
+	if (fstat(dfd, &sbuf) < 0 || sbuf.st_size == 0) {
+		fprintf (stderr, "%s: Can't stat %s: %s\n",
+			cmdname, datafile, strerror(errno));
+		exit (EXIT_FAILURE);
+	}
+
+	ptr = (unsigned char *)mmap(0, sbuf.st_size,
+				    PROT_READ, MAP_SHARED, dfd, 0);
+	if (ptr == (unsigned char *)MAP_FAILED) {
+		fprintf (stderr, "%s: Can't read %s: %s\n",
+			cmdname, datafile, strerror(errno));
+		exit (EXIT_FAILURE);
+	}
+
+	n = (sbuf.st_size + opt_chunk - 1) / opt_chunk;
+	isize = sizeof(chunk_index_t) + n * sizeof(chunk_entry_t);
+	if ((idx = calloc (1, isize)) == NULL) {
+		fprintf (stderr, "%s: out of memory\n", cmdname);
+		exit (EXIT_FAILURE);
+	}
+
+	/* placeholder, rewritten once the chunk offsets are known */
+	if (write(ifd, idx, isize) != isize) {
+		fprintf (stderr, "%s: Write error on %s: %s\n",
+			cmdname, imagefile, strerror(errno));
+		exit (EXIT_FAILURE);
+	}
+
+	offset = isize;
+	for (i = 0; i < n; i++) {
+		len = sbuf.st_size - i * opt_chunk;
+		if (len > opt_chunk)
+			len = opt_chunk;
+
+		if (opt_comp == IH_COMP_NONE) {
+			out = ptr + i * opt_chunk;
+			outlen = len;
+		} else {
+			out = compress_chunk (ptr + i * opt_chunk, len, &outlen);
+		}
+
+		idx->ci_entry[i].ce_offset = htonl(offset);
+		idx->ci_entry[i].ce_len    = htonl(outlen);
+		idx->ci_entry[i].ce_crc    = htonl(crc32 (0, (const char *)out, outlen));
+
+		if (write(ifd, out, outlen) != outlen ||
+		    ((outlen & 3) &&
+		     write(ifd, &zero, 4 - (outlen & 3)) != 4 - (outlen & 3))) {
+			fprintf (stderr, "%s: Write error on %s: %s\n",
+				cmdname, imagefile, strerror(errno));
+			exit (EXIT_FAILURE);
+		}
+		offset += (outlen + 3) & ~3;
+
+		if (opt_comp != IH_COMP_NONE)
+			free (out);
+	}
+
+	idx->ci_magic      = htonl(IH_CHUNK_MAGIC);
+	idx->ci_chunk_size = htonl(opt_chunk);
+	idx->ci_count      = htonl(n);
+	idx->ci_size       = htonl(sbuf.st_size);
+	idx->ci_crc        = htonl(crc32 (0, (const char *)idx, isize));
+
+	if (lseek(ifd, sizeof(image_header_t), SEEK_SET) < 0 ||
+	    write(ifd, idx, isize) != isize ||
+	    lseek(ifd, 0, SEEK_END) < 0) {
+		fprintf (stderr, "%s: Write error on %s: %s\n",
+			cmdname, imagefile, strerror(errno));
+		exit (EXIT_FAILURE);
+	}
+
+	free (idx);
+	(void) munmap((void *)ptr, sbuf.st_size);
+	(void) close (dfd);
+}
+
 void
 usage ()
 {
 	fprintf (stderr, "Usage: %s -l image\n"
 			 "          -l ==> list image header information\n"
 			 "       %s [-x] -A arch -O os -T type -C comp "
-			 "-a addr -e ep -n name -d data_file[:data_file...] image\n",
+			 "-a addr -e ep -n name [-c size] -d data_file[:data_file...] image\n",
 		cmdname, cmdname);
 	fprintf (stderr, "          -A ==> set architecture to 'arch'\n"
 			 "          -O ==> set operating system to 'os'\n"
 			 "          -T ==> set image type to 'type'\n"
 			 "          -C ==> set compression type 'comp'\n"
+			 "          -c ==> compress in independent chunks of 'size' (hex)\n"
 			 "          -a ==> set load address to 'addr' (hex)\n"
 			 "          -e ==> set entry point to 'ep' (hex)\n"
 			 "          -n ==> set image name to 'name'\n"
@@ -782,6 +975,20 @@ print_header (image_header_t *hdr)
 	printf ("Entry Point:  0x%08X\n", ntohl(hdr->ih_ep));
 	printf ("DRAM Parameter: %x (Parm0=%x Parm1=%x)\n", hdr->ih_dram.dram_parm, hdr->ih_dram.sdr.sdram_cfg0, hdr->ih_dram.sdr.sdram_cfg1);
 
+	if (hdr->ih_comp & IH_COMP_CHUNKED) {
+		chunk_index_t *idx = (chunk_index_t *) (
+					(unsigned long)hdr + sizeof(image_header_t)
+				);
+
+		if (ntohl(idx->ci_magic) != IH_CHUNK_MAGIC) {
+			printf ("Chunks:       bad chunk index\n");
+		} else {
+			printf ("Chunks:       %d x 0x%X Bytes, %d Bytes uncompressed\n",
+				ntohl(idx->ci_count), ntohl(idx->ci_chunk_size),
+				ntohl(idx->ci_size));
+		}
+	}
+
 	if (hdr->ih_type == IH_TYPE_MULTI || hdr->ih_type == IH_TYPE_SCRIPT) {
 		int i, ptrs;
 		uint32_t pos;
@@ -821,11 +1028,12 @@ print_header (image_header_t *hdr)
 static void
 print_type (image_header_t *hdr)
 {
-	printf ("%s %s %s (%s)\n",
+	printf ("%s %s %s (%s%s)\n",
 		put_arch (hdr->ih_arch),
 		put_os   (hdr->ih_os  ),
 		put_type (hdr->ih_type),
-		put_comp (hdr->ih_comp)
+		put_comp (hdr->ih_comp & ~IH_COMP_CHUNKED),
+		(hdr->ih_comp & IH_COMP_CHUNKED) ? ", chunked" : ""
 	);
 }
 
@@ -0,0 +1,48 @@
+/*
+ * Host stand-in for <common.h>: just what drivers/nand_flash.c needs to
+ * build against the simulated NAND controller in ../nandsim.c.
+ */
+#ifndef _NANDSIM_COMMON_H_
+#define _NANDSIM_COMMON_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+typedef unsigned char		uchar;
+typedef unsigned char		u8;
+typedef unsigned short		u16;
+typedef unsigned int		u32;
+typedef unsigned long		ulong;
+typedef unsigned char		__u8;
+typedef unsigned int		__u32;
+
+#define min(X, Y)				\
+	({ typeof (X) __x = (X), __y = (Y);	\
+		(__x < __y) ? __x : __y; })
+
+/* the NFC is little endian, and so are the hosts this runs on */
+#define le32_to_cpu(x)		(x)
+
+/* <linux/mtd/nand.h> in the firmware build */
+enum { FL_READY, FL_READING, FL_WRITING };
+
+/* every register access of the driver goes to the simulator */
+u32	sim_inl (ulong addr);
+void	sim_outl (ulong addr, u32 val);
+
+#define ra_inl(addr)		sim_inl((ulong)(addr))
+#define ra_outl(addr, value)	sim_outl((ulong)(addr), (value))
+
+void	udelay (unsigned long usec);
+ulong	get_timer (ulong base);
+char	*sim_getenv (const char *name);
+
+#define getenv			sim_getenv
+int	flash_gen_bump (ulong addr, ulong len);
+void	invalidate_dcache_range (ulong start, ulong stop);
+
+#define simple_strtoul		strtoul
+
+#endif	/* _NANDSIM_COMMON_H_ */
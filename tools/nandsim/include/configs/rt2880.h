@@ -0,0 +1,16 @@
+/*
+ * Host stand-in for <configs/rt2880.h>: an RT3052 booting from a 32 MB
+ * small page NAND.  The load address is a host buffer in ../nandsim.c.
+ */
+#ifndef __CONFIG_H
+#define __CONFIG_H
+
+#define CFG_FLASH_BASE		0xBF000000
+#define CFG_BOOTLOADER_SIZE	0x30000
+#define CFG_CONFIG_SIZE		0x10000
+#define CFG_FACTORY_SIZE	0x10000
+
+extern char sim_load[];
+#define CFG_LOAD_ADDR		((ulong)sim_load)
+
+#endif	/* __CONFIG_H */
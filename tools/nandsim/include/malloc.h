@@ -0,0 +1,2 @@
+/* host stand-in for <malloc.h> */
+#include <stdlib.h>
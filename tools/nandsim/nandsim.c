@@ -0,0 +1,673 @@
+/*
+ * Host simulator for drivers/nand_flash.c
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The driver is built as it is, with ra_inl()/ra_outl() pointed at
+ * sim_inl()/sim_outl() by include/common.h.  Those model the RT3052
+ * NAND controller (NFC_CTRL .. NFC_INT_ST) in front of a 32 MB small
+ * page part held in host memory: READ0/READ1/READOOB, page program,
+ * block erase, status and ID.  dma_dev_read(), dma_dev_read_split()
+ * and dma_dev_wait() stand in for the GDMA channels paced by the
+ * controller.
+ *
+ * The ECC the controller computes is not documented.  The one here is
+ * a line and column parity over the inverted data, so that an erased
+ * page gives 0 as the driver expects; it is written to OOB bytes 5..7
+ * on program and latched in NFC_ECC on read, like the real one.
+ *
+ * Faults can be injected: factory bad blocks, bit flips that show on
+ * one read only or on every read, bits stuck at 0 that a program cannot
+ * set, and an rx overrun on a GDMA read, which drops a word of the data
+ * delivered while the ECC still covers what came off the chip.
+ *
+ * Time is simulated.  A register access costs 'reg_cycles' bus cycles,
+ * udelay() what it is asked for.  A read takes tR and then tRC per
+ * byte, and PIO data only becomes ready as it comes off the chip.
+ *
+ *	nandsim [-r reg_cycles] [-t tR_us] [-g]
+ *
+ * runs a fixed set of writes and reads with faults along the way,
+ * checks what the driver returns after each and prints the simulated
+ * time next to the time the host took; -g leaves GDMA out.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <common.h>
+#include <command.h>
+#include <nand_api.h>
+#include <gdma_api.h>
+#include "../../drivers/ralink_nand.h"
+
+unsigned long mips_cpu_feq = 384000000;
+unsigned long mips_bus_feq = 128000000;
+char sim_load[4 * 1024 * 1024];
+
+/* timing model */
+static ulong reg_cycles = 8;		/* bus cycles per register access */
+static ulong tr_ns = 12000;		/* page to data register */
+static ulong trc_ns = 50;		/* one byte out or in */
+static ulong tprog_ns = 200000;		/* typical page program */
+static ulong tbers_ns = 2000000;	/* typical block erase */
+
+/* simulated time and what it went on */
+static unsigned long long sim_ns;
+static unsigned long sim_regs, sim_bytes;
+
+#define PAGE_RAW	(CFG_PAGESIZE + CFG_PAGE_OOBSIZE)
+#define NUM_PAGES	CFG_NUMPAGE
+#define PAGES_PER_BLOCK	(1 << CONFIG_NUMPAGE_PER_BLOCK_BIT)
+
+static const u8 nand_id[4] = { 0xec, 0x75, 0xa5, 0xbd };
+
+static u8 *nand;			/* NUM_PAGES pages of PAGE_RAW bytes */
+static u8 nand_status;			/* of the last program or erase */
+
+/* injected faults */
+#define MAX_FAULTS	16
+
+static struct fault {
+	int	page, bit;		/* bit in the page, OOB included */
+	int	kind;
+} faults[MAX_FAULTS];
+static int n_faults;
+
+#define FAULT_FLIP_ONCE		1	/* the next read of it is wrong */
+#define FAULT_FLIP		2	/* every read of it is wrong */
+#define FAULT_STUCK0		3	/* a program cannot set it */
+
+static int overrun_next;		/* GDMA reads until one overruns */
+
+/* controller */
+static u32 nfc_ctrl, nfc_cmd1, nfc_cmd2, nfc_cmd3, nfc_addr, nfc_ecc;
+static u32 nfc_int_st;
+
+#define TXN_IDLE	0
+#define TXN_READ	1
+#define TXN_WRITE	2
+#define TXN_WAIT	3	/* no data, done at done_ns */
+
+static struct {
+	int		state;
+	int		gdma;
+	u8		data[PAGE_RAW + 4];
+	int		len, pos;	/* bytes to move, bytes moved */
+	int		page, col;
+	int		ecc;
+	unsigned long long first_ns, done_ns;	/* first byte out, last */
+} txn;
+
+/* the armed GDMA transfer */
+static struct {
+	int		armed, done;
+	u8		*dst, *tail;
+	ulong		len, tail_len;
+	unsigned long long done_ns;
+} dma;
+static int dma_off;
+
+/* ------------------------------------------------------------------ */
+
+/* line and column parity of the inverted data: 0 for an erased page */
+static u32 sim_ecc(const u8 *p)
+{
+	u32 acc = 0, odd = 0, pos;
+	int i, j;
+
+	for (i = 0; i < CFG_PAGESIZE; i++) {
+		u8 b = ~p[i];
+
+		for (j = 0; j < 8; j++)
+			if (b & (1 << j)) {
+				pos = (i << 3) | j;
+				acc ^= pos;
+				odd ^= 1;
+			}
+	}
+	return acc | (((odd ? ~acc : acc) & 0xfff) << 12);
+}
+
+static u8 *page_ptr(int page)
+{
+	return nand + (size_t)(page & (NUM_PAGES - 1)) * PAGE_RAW;
+}
+
+/* the bytes the chip puts out for 'page', with the faults of a read */
+static void chip_read_page(int page, u8 *out)
+{
+	struct fault *f;
+
+	memcpy(out, page_ptr(page), PAGE_RAW);
+	for (f = faults; f < faults + n_faults; f++) {
+		if (f->page != page)
+			continue;
+		if (f->kind == FAULT_FLIP || f->kind == FAULT_FLIP_ONCE)
+			out[f->bit >> 3] ^= 1 << (f->bit & 7);
+		if (f->kind == FAULT_FLIP_ONCE)
+			f->kind = 0;
+	}
+}
+
+static void chip_program(int page, int col, const u8 *buf, int len)
+{
+	u8 *p = page_ptr(page);
+	struct fault *f;
+	int i;
+
+	for (i = 0; i < len && col + i < PAGE_RAW; i++)
+		p[col + i] &= buf[i];
+	for (f = faults; f < faults + n_faults; f++)
+		if (f->page == page && f->kind == FAULT_STUCK0)
+			p[f->bit >> 3] &= ~(1 << (f->bit & 7));
+	nand_status = NAND_STATUS_READY | NAND_STATUS_WP;
+}
+
+static void chip_erase(int page)
+{
+	int first = page & ~(PAGES_PER_BLOCK - 1);
+
+	memset(page_ptr(first), 0xff, PAGES_PER_BLOCK * PAGE_RAW);
+	nand_status = NAND_STATUS_READY | NAND_STATUS_WP;
+}
+
+/* column of the area the pointer command 'op' selects */
+static int area_col(int op)
+{
+	if (op == NAND_CMD_READOOB)
+		return CFG_PAGESIZE;
+	if (op == NAND_CMD_READ1)
+		return 1 << (CFG_COLUMN_ADDR_CYCLE * 8);
+	return 0;
+}
+
+/* GDMA reads move the whole transaction at once, as they are paced */
+static void dma_deliver(void)
+{
+	u8 *src = txn.data;
+	ulong n = txn.len;
+
+	if (!dma.armed)
+		return;
+	if (overrun_next && --overrun_next == 0) {
+		/* a word lost in the middle, the rest shifted up */
+		memmove(txn.data + 256, txn.data + 260, n - 260);
+		nfc_int_st |= INT_ST_RX_TRAS_ERR;
+	}
+	n = (n + 3) & ~3;
+	if (n != dma.len + dma.tail_len)
+		return;		/* never completes: dma_dev_wait() times out */
+	memcpy(dma.dst, src, dma.len);
+	if (dma.tail)
+		memcpy(dma.tail, src + dma.len, dma.tail_len);
+	dma.done = 1;
+	dma.done_ns = txn.done_ns;
+	txn.pos = txn.len;
+}
+
+/* a write to NFC_CONF starts what CMD1..3 and ADDR describe */
+static void nfc_kick(u32 conf)
+{
+	int op = nfc_cmd1 & 0xff;
+	int len = (conf >> 20) & 0xfff;
+
+	memset(&txn, 0, sizeof(txn));
+	txn.len = len;
+	txn.gdma = !!(conf & (1 << 2));
+
+	if (conf & (1 << 1)) {
+		/* SEQIN: CMD1 holds the pointer command and 0x80 */
+		txn.state = TXN_WRITE;
+		txn.page = nfc_addr >> (CFG_COLUMN_ADDR_CYCLE * 8);
+		txn.col = area_col(op) + (nfc_addr & 0xff);
+		txn.ecc = (conf & (1 << 3)) && txn.col == 0 && len == PAGE_RAW;
+		return;
+	}
+
+	switch (op) {
+	case NAND_CMD_READ0:
+	case NAND_CMD_READ1:
+	case NAND_CMD_READOOB:
+		{
+			u8 raw[PAGE_RAW];
+			int page = nfc_addr >> (CFG_COLUMN_ADDR_CYCLE * 8);
+			int col = area_col(op) + (nfc_addr & 0xff);
+
+			/* the driver never reads on into the next page */
+			chip_read_page(page, raw);
+			if (len > PAGE_RAW - col)
+				len = txn.len = PAGE_RAW - col;
+			memcpy(txn.data, raw + col, len);
+			nfc_ecc = 0;
+			if ((conf & (1 << 3)) && col == 0 && len >= CFG_PAGESIZE)
+				nfc_ecc = sim_ecc(txn.data);
+			txn.state = TXN_READ;
+			txn.first_ns = sim_ns + tr_ns;
+			txn.done_ns = txn.first_ns + (unsigned long long)len * trc_ns;
+			sim_bytes += len;
+			if (txn.gdma)
+				dma_deliver();
+		}
+		break;
+	case NAND_CMD_READID:
+		memcpy(txn.data, nand_id, sizeof(nand_id));
+		txn.state = TXN_READ;
+		txn.first_ns = sim_ns;
+		txn.done_ns = sim_ns + len * trc_ns;
+		break;
+	case NAND_CMD_STATUS:
+		txn.data[0] = nand_status;
+		txn.state = TXN_READ;
+		txn.first_ns = sim_ns;
+		txn.done_ns = sim_ns + trc_ns;
+		break;
+	case NAND_CMD_ERASE1:
+		chip_erase(nfc_addr);
+		txn.state = TXN_WAIT;
+		txn.done_ns = sim_ns + tbers_ns;
+		break;
+	case NAND_CMD_RESET:
+	default:
+		nand_status = NAND_STATUS_READY | NAND_STATUS_WP;
+		txn.state = TXN_WAIT;
+		txn.done_ns = sim_ns;
+		break;
+	}
+}
+
+/* what a poll of NFC_INT_ST sees at the current time */
+static u32 nfc_int_status(void)
+{
+	u32 st = nfc_int_st;
+
+	switch (txn.state) {
+	case TXN_IDLE:
+		st |= INT_ST_TX_BUF_RDY;
+		break;
+	case TXN_READ:
+		if (txn.pos >= txn.len) {
+			if (sim_ns >= txn.done_ns) {
+				nfc_int_st |= INT_ST_ND_DONE;
+				txn.state = TXN_IDLE;
+				st |= INT_ST_ND_DONE;
+			}
+		}
+		else if (!txn.gdma && sim_ns >= txn.first_ns +
+			 (unsigned long long)min(txn.pos + 4, txn.len) * trc_ns)
+			st |= INT_ST_RX_BUF_RDY;
+		break;
+	case TXN_WRITE:
+		if (txn.pos < txn.len)
+			st |= INT_ST_TX_BUF_RDY;
+		else if (sim_ns >= txn.done_ns) {
+			nfc_int_st |= INT_ST_ND_DONE;
+			txn.state = TXN_IDLE;
+			st |= INT_ST_ND_DONE;
+		}
+		break;
+	case TXN_WAIT:
+		if (sim_ns >= txn.done_ns) {
+			nfc_int_st |= INT_ST_ND_DONE;
+			txn.state = TXN_IDLE;
+			st |= INT_ST_ND_DONE;
+		}
+		break;
+	}
+	return st;
+}
+
+static u32 nfc_data_in(void)
+{
+	u32 w = 0;
+	int i;
+
+	if (txn.state != TXN_READ || txn.gdma)
+		return 0;
+	for (i = 0; i < 4; i++)
+		if (txn.pos + i < txn.len)
+			w |= txn.data[txn.pos + i] << (8 * i);
+	txn.pos += 4;
+	return w;
+}
+
+static void nfc_data_out(u32 w)
+{
+	int i;
+
+	if (txn.state != TXN_WRITE || txn.pos >= txn.len)
+		return;
+	for (i = 0; i < 4 && txn.pos < txn.len; i++)
+		txn.data[txn.pos++] = w >> (8 * i);
+	sim_bytes += i;
+	if (txn.pos < txn.len)
+		return;
+
+	if (txn.ecc) {
+		u32 ecc = sim_ecc(txn.data);
+
+		txn.data[CFG_PAGESIZE + CONFIG_ECC_OFFSET] = ecc;
+		txn.data[CFG_PAGESIZE + CONFIG_ECC_OFFSET + 1] = ecc >> 8;
+		txn.data[CFG_PAGESIZE + CONFIG_ECC_OFFSET + 2] = ecc >> 16;
+	}
+	chip_program(txn.page, txn.col, txn.data, txn.len);
+	txn.done_ns = sim_ns + (unsigned long long)txn.len * trc_ns + tprog_ns;
+}
+
+static void reg_time(void)
+{
+	sim_ns += reg_cycles * 1000000000ULL / mips_bus_feq;
+	sim_regs++;
+}
+
+u32 sim_inl(ulong addr)
+{
+	reg_time();
+
+	switch (addr) {
+	case NFC_CTRL:
+		return nfc_ctrl;
+	case NFC_INT_ST:
+		return nfc_int_status();
+	case NFC_DATA:
+		return nfc_data_in();
+	case NFC_ECC:
+		return nfc_ecc;
+	case NFC_STATUS:
+		return 0x04;	/* controller idle, chip ready */
+	}
+	return 0;
+}
+
+void sim_outl(ulong addr, u32 val)
+{
+	reg_time();
+
+	switch (addr) {
+	case NFC_CTRL:
+		if (val & 0x02)
+			memset(&txn, 0, sizeof(txn));
+		nfc_ctrl = val;
+		break;
+	case NFC_CMD1:
+		nfc_cmd1 = val;
+		break;
+	case NFC_CMD2:
+		nfc_cmd2 = val;
+		break;
+	case NFC_CMD3:
+		nfc_cmd3 = val;
+		break;
+	case NFC_ADDR:
+		nfc_addr = val;
+		break;
+	case NFC_CONF:
+		nfc_kick(val);
+		break;
+	case NFC_DATA:
+		nfc_data_out(val);
+		break;
+	case NFC_INT_ST:
+		nfc_int_st &= ~val;
+		break;
+	}
+}
+
+int dma_dev_read(void *dst, ulong fifo, int req, ulong len)
+{
+	return dma_dev_read_split(dst, len, NULL, 0, fifo, req);
+}
+
+int dma_dev_read_split(void *dst, ulong len, void *tail, ulong tail_len,
+		ulong fifo, int req)
+{
+	if (dma_off || (len & 3) || (tail_len & 3))
+		return -1;
+	memset(&dma, 0, sizeof(dma));
+	dma.armed = 1;
+	dma.dst = dst;
+	dma.len = len;
+	dma.tail = tail;
+	dma.tail_len = tail_len;
+	return 0;
+}
+
+/* as gdma_wait(): 100 ms and the engine is given up on */
+int dma_dev_wait(void)
+{
+	int done = dma.armed && dma.done;
+
+	if (!done) {
+		sim_ns += 100000000ULL;
+		dma_off = 1;
+	}
+	else if (sim_ns < dma.done_ns)
+		sim_ns = dma.done_ns;
+	dma.armed = 0;
+	return done ? 0 : -1;
+}
+
+void invalidate_dcache_range(ulong start, ulong stop)
+{
+}
+
+void udelay(unsigned long usec)
+{
+	sim_ns += usec * 1000ULL;
+}
+
+/* CP0 Count ticks, at half the CPU clock */
+ulong get_timer(ulong base)
+{
+	return (ulong)(sim_ns / 1000 * (mips_cpu_feq / 2 / 1000000)) - base;
+}
+
+char *sim_getenv(const char *name)
+{
+	return NULL;
+}
+
+int flash_gen_bump(ulong addr, ulong len)
+{
+	return 0;
+}
+
+/* ------------------------------------------------------------------ */
+
+static unsigned long long host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct bench {
+	const char	*what;
+	int		len, ok;
+	unsigned long long ns, host;
+	unsigned long	regs, bytes;
+};
+
+#define N_BENCH		10
+
+static struct bench bench[N_BENCH];
+static int n_bench;
+
+static void bench_start(const char *what, int len)
+{
+	struct bench *b = &bench[n_bench];
+
+	printf("--- %s\n", what);
+	b->what = what;
+	b->len = len;
+	b->ns = sim_ns;
+	b->regs = sim_regs;
+	b->bytes = sim_bytes;
+	b->host = host_ns();
+}
+
+static int bench_stop(int ok)
+{
+	struct bench *b = &bench[n_bench++];
+
+	b->host = host_ns() - b->host;
+	b->ns = sim_ns - b->ns;
+	b->regs = sim_regs - b->regs;
+	b->bytes = sim_bytes - b->bytes;
+	b->ok = ok;
+	return !ok;
+}
+
+static void bench_print(void)
+{
+	struct bench *b;
+	unsigned long long us;
+
+	printf("\n%-28s %8s %10s %7s %9s %9s %8s\n", "", "bytes",
+		"sim us", "kB/s", "reg acc", "nfc bytes", "host us");
+	for (b = bench; b < bench + n_bench; b++) {
+		us = b->ns / 1000 ? b->ns / 1000 : 1;
+		printf("%-28s %8d %10llu %7llu %9lu %9lu %8llu  %s\n",
+			b->what, b->len, us,
+			(unsigned long long)b->len * 1000000 / 1024 / us,
+			b->regs, b->bytes, b->host / 1000,
+			b->ok ? "ok" : "FAIL");
+	}
+}
+
+static void fault_add(int page, int bit, int kind)
+{
+	if (n_faults < MAX_FAULTS) {
+		faults[n_faults].page = page;
+		faults[n_faults].bit = bit;
+		faults[n_faults].kind = kind;
+		n_faults++;
+	}
+}
+
+/* not in <nand_api.h>, nothing outside the driver asks */
+int ranand_block_isbad(loff_t offs);
+
+static void nand_cmd(char *sub)
+{
+	extern cmd_tbl_t __u_boot_cmd_nand;
+	char *argv[] = { "nand", sub, NULL };
+
+	__u_boot_cmd_nand.cmd(&__u_boot_cmd_nand, 0, 2, argv);
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: nandsim [-r reg_cycles] [-t tR_us] [-g]\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	const int offs = 0x100000, len = 0x100000;
+	const int page0 = offs / CFG_PAGESIZE;
+	const int bad_block = page0 / PAGES_PER_BLOCK + 5;
+	const int weak_block = page0 / PAGES_PER_BLOCK + 20;
+	char *buf;
+	int c, i, bad = 0;
+
+	while ((c = getopt(argc, argv, "r:t:g")) != -1) {
+		switch (c) {
+		case 'r': reg_cycles = strtoul(optarg, NULL, 0); break;
+		case 't': tr_ns = strtoul(optarg, NULL, 0) * 1000; break;
+		case 'g': dma_off = 1; break;
+		default: usage();
+		}
+	}
+
+	nand = malloc((size_t)NUM_PAGES * PAGE_RAW);
+	buf = malloc(len);
+	if (!nand || !buf) {
+		fprintf(stderr, "nandsim: out of memory\n");
+		return 1;
+	}
+	srand(1);
+	for (i = 0; i < len; i++)
+		buf[i] = rand();
+
+	/* erased, but for a block the factory marked bad in the test range */
+	memset(nand, 0xff, (size_t)NUM_PAGES * PAGE_RAW);
+	page_ptr(bad_block * PAGES_PER_BLOCK)[CFG_PAGESIZE + CONFIG_BAD_BLOCK_POS] = 0;
+
+	if (ranand_init() != CFG_CHIPSIZE) {
+		fprintf(stderr, "nandsim: chip not found\n");
+		return 1;
+	}
+
+	bench_start("erase_write", len);
+	bad |= bench_stop(ranand_erase_write(buf, offs, len) == 0);
+
+	bench_start("read", len);
+	bad |= bench_stop(ranand_read(sim_load, offs, len) == len &&
+		memcmp(sim_load, buf, len) == 0);
+
+	/* a flip the retry does not see again */
+	fault_add(page0 + 40, 1234, FAULT_FLIP_ONCE);
+	bench_start("read, flip once", len);
+	bad |= bench_stop(ranand_read(sim_load, offs, len) == len &&
+		memcmp(sim_load, buf, len) == 0);
+
+	/* a flip on every read: the driver has to say so */
+	fault_add(page0 + 70, 77, FAULT_FLIP);
+	bench_start("read, flip every time", len);
+	bad |= bench_stop(ranand_read(sim_load, offs, len) < 0);
+	faults[--n_faults].kind = 0;
+
+	/* GDMA loses a word: back to PIO with the right data */
+	overrun_next = dma_off ? 0 : 10;
+	bench_start("read, rx overrun", len);
+	bad |= bench_stop(ranand_read(sim_load, offs, len) == len &&
+		memcmp(sim_load, buf, len) == 0);
+
+	bench_start("read, pio", len);
+	bad |= bench_stop(ranand_read(sim_load, offs, len) == len &&
+		memcmp(sim_load, buf, len) == 0);
+
+	/*
+	 * A block that loses a bit on program fails the read back of its
+	 * first page, is marked bad and the write is refused; written again,
+	 * the data goes around it.
+	 */
+	for (i = 0; i < len; i += CFG_BLOCKSIZE)
+		buf[i] ^= 0x5a;
+	for (i = 0; i < 8; i++)
+		fault_add(weak_block * PAGES_PER_BLOCK, i, FAULT_STUCK0);
+	bench_start("erase_write, block goes bad", len);
+	bad |= bench_stop(ranand_erase_write(buf, offs, len) != 0 &&
+		ranand_block_isbad((loff_t)weak_block * CFG_BLOCKSIZE));
+
+	bench_start("erase_write again", len);
+	bad |= bench_stop(ranand_erase_write(buf, offs, len) == 0 &&
+		ranand_read(sim_load, offs, len) == len &&
+		memcmp(sim_load, buf, len) == 0);
+
+	printf("\n");
+	nand_cmd("ecc");
+	nand_cmd("bbt");
+	bench_print();
+	return bad;
+}
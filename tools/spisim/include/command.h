@@ -0,0 +1,19 @@
+/*
+ * Host stand-in for <command.h>: commands are built but never run.
+ */
+#ifndef _SPISIM_COMMAND_H_
+#define _SPISIM_COMMAND_H_
+
+typedef struct cmd_tbl_s {
+	char	*name;
+	int	maxargs;
+	int	repeatable;
+	int	(*cmd)(struct cmd_tbl_s *, int, int, char *[]);
+	char	*usage;
+	char	*help;
+} cmd_tbl_t;
+
+#define U_BOOT_CMD(name,maxargs,rep,cmd,usage,help) \
+cmd_tbl_t __u_boot_cmd_##name = {#name, maxargs, rep, cmd, usage, help}
+
+#endif	/* _SPISIM_COMMAND_H_ */
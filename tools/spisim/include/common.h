@@ -0,0 +1,36 @@
+/*
+ * Host stand-in for <common.h>: just what drivers/spi_flash.c needs to
+ * build against the simulated SPI controller in ../spisim.c.
+ */
+#ifndef _SPISIM_COMMON_H_
+#define _SPISIM_COMMON_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+typedef unsigned char		uchar;
+typedef unsigned char		u8;
+typedef unsigned short		u16;
+typedef unsigned int		u32;
+typedef unsigned long		ulong;
+
+#define min(X, Y)				\
+	({ typeof (X) __x = (X), __y = (Y);	\
+		(__x < __y) ? __x : __y; })
+
+/* every register access of the driver goes to the simulator */
+u32	sim_inl (ulong addr);
+void	sim_outl (ulong addr, u32 val);
+
+#define ra_inl(addr)		sim_inl((ulong)(addr))
+#define ra_outl(addr, value)	sim_outl((ulong)(addr), (value))
+
+void	udelay (unsigned long usec);
+ulong	get_timer (ulong base);
+int	flash_gen_bump (ulong addr, ulong len);
+
+#define simple_strtoul		strtoul
+
+#endif	/* _SPISIM_COMMON_H_ */
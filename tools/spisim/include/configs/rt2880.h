@@ -0,0 +1,24 @@
+/*
+ * Host stand-in for <configs/rt2880.h>: an RT3052 with a 16 MB SPI
+ * flash.  The memory mapped window is not simulated, so
+ * CFG_SPI_MMAP_SIZE is left out and every read goes through the
+ * controller.
+ */
+#ifndef __CONFIG_H
+#define __CONFIG_H
+
+#define CFG_CMD_SPI		0x00000001
+#define CONFIG_COMMANDS		CFG_CMD_SPI
+
+#define RT2880_SYS_CNTL_BASE	RALINK_SYSCTL_BASE
+#define RT2880_RSTCTRL_REG	(RT2880_SYS_CNTL_BASE+0x34)
+#define RT2880_GPIOMODE_REG	(RT2880_SYS_CNTL_BASE+0x60)
+
+#define CFG_FLASH_BASE		0xBF000000
+#define CFG_LOAD_ADDR		0x80100000
+#define CFG_BOOTLOADER_SIZE	0x30000
+#define CFG_CONFIG_SIZE		0x10000
+#define CFG_FACTORY_SIZE	0x10000
+#define CFG_KERN_ADDR		(CFG_FLASH_BASE + (CFG_BOOTLOADER_SIZE + CFG_CONFIG_SIZE + CFG_FACTORY_SIZE))
+
+#endif	/* __CONFIG_H */
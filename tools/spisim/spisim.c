@@ -0,0 +1,435 @@
+/*
+ * Host simulator for drivers/spi_flash.c
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The driver is built as it is, with ra_inl()/ra_outl() pointed at
+ * sim_inl()/sim_outl() by include/common.h.  Those model the RT2880 SPI
+ * controller (SPISTAT, SPICFG, SPICTL, SPIDATA) in front of a 16 MB
+ * MX25L12805D held in host memory: JEDEC ID, status register, READ,
+ * FAST_READ, page program, 64 kB sector and chip erase.
+ *
+ * Time is simulated.  A register access costs 'reg_cycles' bus cycles,
+ * a byte on the wire 8 SPI clocks at the SPICFG divider and udelay()
+ * what it is asked for.  Program and erase keep WIP set for their
+ * typical time after chip select goes high.
+ *
+ *	spisim [-p page_us] [-e sector_ms] [-c chip_ms] [-r reg_cycles]
+ *
+ * runs a fixed set of erases, writes and reads through the driver,
+ * checks the flash contents after each and prints the simulated time
+ * and CPU cycles next to the time the host took.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <common.h>
+#include <spi_api.h>
+#include "../../drivers/ralink_spi.h"
+
+unsigned long mips_cpu_feq = 384000000;
+unsigned long mips_bus_feq = 128000000;
+ulong NetBootFileXferSize;
+
+/* timing model */
+static ulong page_us = 1400;		/* typical page program */
+static ulong sector_ms = 700;		/* typical 64 kB sector erase */
+static ulong chip_ms = 80000;		/* typical chip erase */
+static ulong reg_cycles = 8;		/* bus cycles per register access */
+
+/* simulated time and what it went on */
+static unsigned long long sim_ns;
+static unsigned long sim_regs, sim_bytes;
+
+#define FLASH_SIZE	(16 * 1024 * 1024)
+#define SECTOR_SIZE	(64 * 1024)
+
+static const u8 flash_id[5] = { 0xc2, 0x20, 0x18, 0xc2, 0x20 };
+
+static u8 *flash;
+
+static struct {
+	int		selected;
+	u8		op;
+	int		n_in, n_out;	/* bytes in and out since select */
+	u32		addr;
+	int		addr4b;		/* EN4B mode */
+	int		wel;
+	u8		bp;		/* block protect bits */
+	int		busy;
+	unsigned long long busy_until;
+} chip;
+
+static u32 spicfg, spictl, spidata;
+
+/* ------------------------------------------------------------------ */
+
+static int op_addr_len(u8 op)
+{
+	switch (op) {
+	case 0x13: case 0x0c: case 0x12: case 0xdc:
+		return 4;
+	case 0x03: case 0x0b: case 0x02: case 0xd8: case 0x5a:
+		return chip.addr4b ? 4 : 3;
+	}
+	return 0;
+}
+
+static void chip_update(void)
+{
+	if (chip.busy && sim_ns >= chip.busy_until) {
+		chip.busy = 0;
+		chip.wel = 0;
+	}
+}
+
+static void chip_start(unsigned long long ns)
+{
+	chip.busy = 1;
+	chip.busy_until = sim_ns + ns;
+}
+
+static void chip_byte_in(u8 b)
+{
+	int alen;
+
+	chip_update();
+	if (chip.n_in++ == 0) {
+		chip.op = b;
+		chip.addr = 0;
+		return;
+	}
+	alen = op_addr_len(chip.op);
+	if (chip.n_in <= alen + 1) {
+		chip.addr = (chip.addr << 8) | b;
+		return;
+	}
+	switch (chip.op) {
+	case 0x02: case 0x12:
+		/* page program wraps within the page, and only clears bits */
+		if (chip.wel && !chip.busy) {
+			u32 a = chip.addr % FLASH_SIZE;
+			u32 o = (a + chip.n_in - alen - 2) & 0xff;
+
+			flash[(a & ~0xff) | o] &= b;
+		}
+		break;
+	case 0x01:
+		if (chip.wel && !chip.busy && chip.n_in == 2)
+			chip.bp = b & 0x1c;
+		break;
+	}
+}
+
+static u8 chip_byte_out(void)
+{
+	int n = chip.n_out++;
+
+	chip_update();
+	switch (chip.op) {
+	case 0x9f:
+		return (n < sizeof(flash_id)) ? flash_id[n] : 0;
+	case 0x05:
+		return (chip.busy ? 0x01 : 0) | (chip.wel ? 0x02 : 0) | chip.bp;
+	case 0x03: case 0x13: case 0x0b: case 0x0c:
+		if (chip.busy)
+			return 0xff;
+		return flash[(chip.addr + n) % FLASH_SIZE];
+	}
+	/* no SFDP, no security register */
+	return (chip.op == 0x2b) ? 0 : 0xff;
+}
+
+static void chip_deselect(void)
+{
+	u32 a = chip.addr % FLASH_SIZE;
+
+	chip_update();
+	if (chip.n_in == 0)
+		return;
+	if (chip.busy)
+		return;		/* ignored, as by a real part */
+
+	switch (chip.op) {
+	case 0x06:
+		chip.wel = 1;
+		break;
+	case 0x04:
+		chip.wel = 0;
+		break;
+	case 0xb7:
+		chip.addr4b = 1;
+		break;
+	case 0xe9:
+		chip.addr4b = 0;
+		break;
+	case 0x01:
+		if (chip.wel)
+			chip_start(10000);
+		break;
+	case 0x02: case 0x12:
+		if (chip.wel)
+			chip_start(page_us * 1000ULL);
+		break;
+	case 0xd8: case 0xdc:
+		if (chip.wel && !chip.bp) {
+			memset(flash + (a & ~(SECTOR_SIZE - 1)), 0xff, SECTOR_SIZE);
+			chip_start(sector_ms * 1000000ULL);
+		}
+		break;
+	case 0xc7: case 0x60:
+		if (chip.wel && !chip.bp) {
+			memset(flash, 0xff, FLASH_SIZE);
+			chip_start(chip_ms * 1000000ULL);
+		}
+		break;
+	}
+}
+
+/* ------------------------------------------------------------------ */
+
+/* 8 SPI clocks, the bus clock divided by 2 << div */
+static void spi_byte_time(void)
+{
+	sim_ns += 8ULL * (2 << (spicfg & 7)) * 1000000000ULL / mips_bus_feq;
+	sim_bytes++;
+}
+
+u32 sim_inl(ulong addr)
+{
+	sim_ns += reg_cycles * 1000000000ULL / mips_bus_feq;
+	sim_regs++;
+
+	switch (addr) {
+	case RT2880_SPISTAT_REG:
+		return 0;	/* each byte is done by the next access */
+	case RT2880_SPICFG_REG:
+		return spicfg;
+	case RT2880_SPICTL_REG:
+		return spictl;
+	case RT2880_SPIDATA_REG:
+		return spidata;
+	}
+	return 0;
+}
+
+void sim_outl(ulong addr, u32 val)
+{
+	u32 old;
+
+	sim_ns += reg_cycles * 1000000000ULL / mips_bus_feq;
+	sim_regs++;
+
+	switch (addr) {
+	case RT2880_SPICFG_REG:
+		spicfg = val;
+		break;
+	case RT2880_SPIDATA_REG:
+		spidata = val;
+		break;
+	case RT2880_SPICTL_REG:
+		old = spictl;
+		spictl = val & ~(SPICTL_STARTWR | SPICTL_STARTRD);
+		if ((old & SPICTL_SPIENA_HIGH) && !(val & SPICTL_SPIENA_HIGH)) {
+			chip.selected = 1;
+			chip.n_in = chip.n_out = 0;
+		}
+		else if (!(old & SPICTL_SPIENA_HIGH) && (val & SPICTL_SPIENA_HIGH)) {
+			chip.selected = 0;
+			chip_deselect();
+		}
+		if (!chip.selected)
+			break;
+		if (val & SPICTL_STARTWR) {
+			spi_byte_time();
+			chip_byte_in(spidata & 0xff);
+		}
+		if (val & SPICTL_STARTRD) {
+			spi_byte_time();
+			spidata = chip_byte_out();
+		}
+		break;
+	}
+}
+
+void udelay(unsigned long usec)
+{
+	sim_ns += usec * 1000ULL;
+}
+
+/* CP0 Count ticks, at half the CPU clock */
+ulong get_timer(ulong base)
+{
+	return (ulong)(sim_ns / 1000 * (mips_cpu_feq / 2 / 1000000)) - base;
+}
+
+int flash_gen_bump(ulong addr, ulong len)
+{
+	return 0;
+}
+
+void *dma_memcpy(void *dst, const void *src, size_t len)
+{
+	return memmove(dst, src, len);
+}
+
+/* ------------------------------------------------------------------ */
+
+static unsigned long long host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct bench {
+	const char	*what;
+	int		len, ok;
+	unsigned long long ns, host;
+	unsigned long	regs, bytes;
+};
+
+#define N_BENCH		5
+
+static struct bench bench[N_BENCH];
+static int n_bench;
+
+static void bench_start(const char *what, int len)
+{
+	struct bench *b = &bench[n_bench];
+
+	b->what = what;
+	b->len = len;
+	b->ns = sim_ns;
+	b->regs = sim_regs;
+	b->bytes = sim_bytes;
+	b->host = host_ns();
+}
+
+static int bench_stop(int ok)
+{
+	struct bench *b = &bench[n_bench++];
+
+	b->host = host_ns() - b->host;
+	b->ns = sim_ns - b->ns;
+	b->regs = sim_regs - b->regs;
+	b->bytes = sim_bytes - b->bytes;
+	b->ok = ok;
+	return !ok;
+}
+
+static void bench_print(void)
+{
+	struct bench *b;
+	unsigned long long us;
+
+	printf("\n%-24s %8s %11s %9s %7s %9s %9s %8s\n", "", "bytes",
+		"sim us", "sim Mcyc", "kB/s", "reg acc", "spi bytes", "host us");
+	for (b = bench; b < bench + n_bench; b++) {
+		us = b->ns / 1000 ? b->ns / 1000 : 1;
+		printf("%-24s %8d %11llu %9llu %7llu %9lu %9lu %8llu  %s\n",
+			b->what, b->len, us, us * (mips_cpu_feq / 1000000) / 1000000,
+			(unsigned long long)b->len * 1000000 / 1024 / us,
+			b->regs, b->bytes, b->host / 1000,
+			b->ok ? "ok" : "MISMATCH");
+	}
+}
+
+static int is_erased(int offs, int len)
+{
+	while (len-- > 0)
+		if (flash[offs++] != 0xff)
+			return 0;
+	return 1;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: spisim [-p page_us] [-e sector_ms] [-c chip_ms] [-r reg_cycles]\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	const int offs = 0x100000, len = 0x100000;
+	char *buf, *rbuf;
+	int c, i, bad = 0;
+
+	while ((c = getopt(argc, argv, "p:e:c:r:")) != -1) {
+		switch (c) {
+		case 'p': page_us = strtoul(optarg, NULL, 0); break;
+		case 'e': sector_ms = strtoul(optarg, NULL, 0); break;
+		case 'c': chip_ms = strtoul(optarg, NULL, 0); break;
+		case 'r': reg_cycles = strtoul(optarg, NULL, 0); break;
+		default: usage();
+		}
+	}
+
+	flash = malloc(FLASH_SIZE);
+	buf = malloc(len);
+	rbuf = malloc(len);
+	if (!flash || !buf || !rbuf) {
+		fprintf(stderr, "spisim: out of memory\n");
+		return 1;
+	}
+	srand(1);
+	for (i = 0; i < len; i++)
+		buf[i] = rand();
+
+	/* an erased part, but for something to erase in the test range */
+	memset(flash, 0xff, FLASH_SIZE);
+	memset(flash + offs, 0, len);
+
+	/* chip select is high until spic_init() says otherwise */
+	spictl = SPICTL_SPIENA_HIGH;
+	if (raspi_init() != FLASH_SIZE) {
+		fprintf(stderr, "spisim: chip not found\n");
+		return 1;
+	}
+
+	bench_start("erase", len);
+	bad |= bench_stop(raspi_erase(offs, len) == 0 && is_erased(offs, len));
+
+	bench_start("write", len);
+	bad |= bench_stop(raspi_write(buf, offs, len) == len &&
+		memcmp(flash + offs, buf, len) == 0);
+
+	bench_start("read", len);
+	bad |= bench_stop(raspi_read(rbuf, offs, len) == len &&
+		memcmp(rbuf, buf, len) == 0);
+
+	bench_start("erase_write, unchanged", len);
+	bad |= bench_stop(raspi_erase_write(buf, offs, len) == 0 &&
+		memcmp(flash + offs, buf, len) == 0);
+
+	/* one byte per 4 kB */
+	for (i = 0; i < len; i += 4096)
+		buf[i] ^= 0x5a;
+	bench_start("erase_write, 1 B / 4 kB", len);
+	bad |= bench_stop(raspi_erase_write(buf, offs, len) == 0 &&
+		memcmp(flash + offs, buf, len) == 0);
+
+	bench_print();
+	return bad;
+}
@@ -0,0 +1,9 @@
+/*
+ * Host stand-in for <linux/ctype.h>.
+ */
+#ifndef _STRFUZZ_LINUX_CTYPE_H_
+#define _STRFUZZ_LINUX_CTYPE_H_
+
+#include <ctype.h>
+
+#endif	/* _STRFUZZ_LINUX_CTYPE_H_ */
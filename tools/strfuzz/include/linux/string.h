@@ -0,0 +1,39 @@
+/*
+ * Host stand-in for <linux/string.h>.  Everything lib_generic/string.c
+ * defines gets a ub_ prefix, so that it links next to the host libc and
+ * ../strfuzz.c can hold the two against each other.  No __HAVE_ARCH_*
+ * is defined: the generic C versions are built, not the MIPS ones.
+ */
+#ifndef _STRFUZZ_LINUX_STRING_H_
+#define _STRFUZZ_LINUX_STRING_H_
+
+#define strnicmp	ub_strnicmp
+#define ___strtok	ub____strtok
+#define strcpy		ub_strcpy
+#define strncpy		ub_strncpy
+#define strcat		ub_strcat
+#define strncat		ub_strncat
+#define strcmp		ub_strcmp
+#define strncmp		ub_strncmp
+#define strchr		ub_strchr
+#define strrchr		ub_strrchr
+#define strlen		ub_strlen
+#define strnlen		ub_strnlen
+#define strdup		ub_strdup
+#define strspn		ub_strspn
+#define strpbrk		ub_strpbrk
+#define strtok		ub_strtok
+#define strsep		ub_strsep
+#define strswab		ub_strswab
+#define memset		ub_memset
+#define bcopy		ub_bcopy
+#define memcpy		ub_memcpy
+#define memmove		ub_memmove
+#define memcmp		ub_memcmp
+#define memscan		ub_memscan
+#define strstr		ub_strstr
+#define memchr		ub_memchr
+
+#include <ub_string.h>
+
+#endif	/* _STRFUZZ_LINUX_STRING_H_ */
@@ -0,0 +1,11 @@
+/*
+ * Host stand-in for <linux/types.h>: lib_generic/string.c only needs
+ * size_t and NULL.
+ */
+#ifndef _STRFUZZ_LINUX_TYPES_H_
+#define _STRFUZZ_LINUX_TYPES_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#endif	/* _STRFUZZ_LINUX_TYPES_H_ */
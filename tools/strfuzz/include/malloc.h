@@ -0,0 +1,9 @@
+/*
+ * Host stand-in for <malloc.h>.
+ */
+#ifndef _STRFUZZ_MALLOC_H_
+#define _STRFUZZ_MALLOC_H_
+
+#include <stdlib.h>
+
+#endif	/* _STRFUZZ_MALLOC_H_ */
@@ -0,0 +1,38 @@
+/*
+ * The lib_generic/string.c functions under the names the host build
+ * gives them, see <linux/string.h> here.
+ */
+#ifndef _STRFUZZ_UB_STRING_H_
+#define _STRFUZZ_UB_STRING_H_
+
+#include <stddef.h>
+
+extern char *ub____strtok;
+
+int	ub_strnicmp (const char *, const char *, size_t);
+char	*ub_strcpy (char *, const char *);
+char	*ub_strncpy (char *, const char *, size_t);
+char	*ub_strcat (char *, const char *);
+char	*ub_strncat (char *, const char *, size_t);
+int	ub_strcmp (const char *, const char *);
+int	ub_strncmp (const char *, const char *, size_t);
+char	*ub_strchr (const char *, int);
+char	*ub_strrchr (const char *, int);
+size_t	ub_strlen (const char *);
+size_t	ub_strnlen (const char *, size_t);
+char	*ub_strdup (const char *);
+size_t	ub_strspn (const char *, const char *);
+char	*ub_strpbrk (const char *, const char *);
+char	*ub_strtok (char *, const char *);
+char	*ub_strsep (char **, const char *);
+char	*ub_strswab (const char *);
+void	*ub_memset (void *, int, size_t);
+char	*ub_bcopy (const char *, char *, int);
+void	*ub_memcpy (void *, const void *, size_t);
+void	*ub_memmove (void *, const void *, size_t);
+int	ub_memcmp (const void *, const void *, size_t);
+void	*ub_memscan (void *, int, size_t);
+char	*ub_strstr (const char *, const char *);
+void	*ub_memchr (const void *, int, size_t);
+
+#endif	/* _STRFUZZ_UB_STRING_H_ */
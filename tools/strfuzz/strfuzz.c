@@ -0,0 +1,381 @@
+/*
+ * Differential test of lib_generic/string.c against the host libc
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * lib_generic/string.c is built with its functions renamed ub_*, see
+ * include/linux/string.h, and each of the ones that work a word at a
+ * time is run on random cases next to the libc function of the same
+ * name.  Results must match: lengths and pointers exactly, comparisons
+ * in sign, and the bytes a fill or copy leaves, inside the area and
+ * around it.
+ *
+ * The cases are what the word loops get wrong: every alignment of each
+ * pointer, lengths around the word size, and bytes drawn mostly from
+ * 0x00, 0x01, 0x7f, 0x80, 0xfe and 0xff, which trip a careless has-zero
+ * test.  Each area is placed either in the middle of a page or right up
+ * against an inaccessible one, so that a word load past the end that
+ * crosses into the next page faults.
+ *
+ *	strfuzz [-n cases] [-s seed]
+ *
+ * runs 'cases' cases per function (200000 by default) from 'seed'
+ * (1 by default), and stops at the first mismatch with the seed and
+ * case number that reproduce it.  The word size is the host's, so a
+ * 32 bit host build ("make HOSTCC='cc -m32'") covers the MIPS one.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <ub_string.h>
+
+#define MAX_LEN		300
+#define SLACK		64		/* around a fill or copy */
+
+static unsigned long n_cases = 200000;
+static unsigned long seed = 1;
+
+static unsigned char *pages;		/* two areas, each against a guard page */
+static unsigned long page_size;
+
+/* xorshift, so that a seed means the same cases on every host */
+static unsigned long long rnd_state;
+
+static unsigned long rnd(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 7;
+	rnd_state ^= rnd_state << 17;
+	return (unsigned long)(rnd_state >> 11);
+}
+
+static unsigned int rnd_len(void)
+{
+	switch (rnd() % 4) {
+	case 0:
+		return rnd() % 20;
+	case 1:
+		return rnd() % (4 * sizeof(unsigned long));
+	default:
+		return rnd() % MAX_LEN;
+	}
+}
+
+static unsigned char rnd_byte(void)
+{
+	static const unsigned char hard[] = { 0x01, 0x7f, 0x80, 0xfe, 0xff, 'a' };
+
+	if (rnd() % 4)
+		return hard[rnd() % sizeof(hard)];
+	return rnd();
+}
+
+/* 'len' bytes in area 'which', at the end of its page or somewhere inside */
+static unsigned char *area(int which, unsigned long len)
+{
+	unsigned char *end = pages + (2 * which + 1) * page_size;
+
+	if (rnd() % 2)
+		return end - len;
+	return end - len - SLACK - rnd() % 64;
+}
+
+static void fill(unsigned char *p, unsigned long len)
+{
+	while (len--)
+		*p++ = rnd_byte();
+}
+
+/* a string of 'len' characters and its terminator at 'p' */
+static void fill_str(unsigned char *p, unsigned long len)
+{
+	unsigned long i;
+
+	for (i = 0; i < len; i++)
+		while ((p[i] = rnd_byte()) == 0)
+			;
+	p[len] = 0;
+}
+
+static int fail(const char *what, unsigned long i, const char *fmt, ...)
+	__attribute__ ((format (printf, 3, 4)));
+
+static int fail(const char *what, unsigned long i, const char *fmt, ...)
+{
+	va_list ap;
+
+	printf("%s: case %lu of seed %lu: ", what, i, seed);
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+	printf("\n");
+	return 1;
+}
+
+/* where a load past the end hit a guard page */
+static const char *cur_name;
+static unsigned long cur_case;
+
+static void segv(int sig)
+{
+	char msg[128];
+	int n;
+
+	n = snprintf(msg, sizeof(msg), "%s: case %lu of seed %lu: read past the end\n",
+		cur_name, cur_case, seed);
+	write(1, msg, n);
+	_exit(1);
+}
+
+static int sign(int x)
+{
+	return (x > 0) - (x < 0);
+}
+
+static int test_strlen(unsigned long i)
+{
+	unsigned long len = rnd_len();
+	unsigned char *s = area(0, len + 1);
+	size_t n;
+
+	fill_str(s, len);
+	if ((n = ub_strlen((char *)s)) != len)
+		return fail("strlen", i, "%p: %zu, not %lu", s, n, len);
+	return 0;
+}
+
+static int test_strnlen(unsigned long i)
+{
+	unsigned long len = rnd_len(), max = rnd_len();
+	unsigned char *s;
+	size_t n, want;
+
+	/* without a terminator in reach strnlen() must stop at 'max' */
+	if (max <= len && rnd() % 2) {
+		s = area(0, max);
+		fill(s, max);
+		for (n = 0; n < max; n++)
+			if (!s[n])
+				s[n] = 'a';
+	}
+	else {
+		s = area(0, len + 1);
+		fill_str(s, len);
+	}
+	want = strnlen((char *)s, max);
+	if ((n = ub_strnlen((char *)s, max)) != want)
+		return fail("strnlen", i, "%p, %lu: %zu, not %zu", s, max, n, want);
+	return 0;
+}
+
+static int test_memchr(unsigned long i)
+{
+	unsigned long len = rnd_len();
+	unsigned char *s = area(0, len);
+	int c = rnd_byte();
+	void *p, *want;
+
+	fill(s, len);
+	/* mostly absent, so that the whole area is scanned */
+	if (rnd() % 3 == 0 && len)
+		s[rnd() % len] = c;
+	else
+		for (p = s; (p = memchr(s, c, len)) != NULL; )
+			*(unsigned char *)p = c ^ 0x01;
+	if (rnd() % 4 == 0)
+		c |= 0x100 * (rnd() % 0x100);	/* only the low byte counts */
+	want = memchr(s, c, len);
+	if ((p = ub_memchr(s, c, len)) != want)
+		return fail("memchr", i, "%p, %#x, %lu: %p, not %p", s, c, len, p, want);
+	return 0;
+}
+
+static int test_memcmp(unsigned long i)
+{
+	unsigned long len = rnd_len();
+	unsigned char *a = area(0, len), *b = area(1, len);
+	int r, want;
+
+	fill(a, len);
+	memcpy(b, a, len);
+	if (len && rnd() % 4) {
+		unsigned long at = rnd() % len;
+
+		while ((b[at] = rnd_byte()) == a[at])
+			;
+	}
+	want = sign(memcmp(a, b, len));
+	if ((r = sign(ub_memcmp(a, b, len))) != want)
+		return fail("memcmp", i, "%p, %p, %lu: %d, not %d", a, b, len, r, want);
+	return 0;
+}
+
+static int test_strcmp(unsigned long i)
+{
+	unsigned long len = rnd_len(), n = rnd_len();
+	unsigned char *a = area(0, len + 1), *b = area(1, len + 1);
+	int r, want;
+
+	fill_str(a, len);
+	memcpy(b, a, len + 1);
+	/* a different byte, or an early end, somewhere in 'b' */
+	if (len && rnd() % 4) {
+		unsigned long at = rnd() % len;
+
+		while ((b[at] = rnd() % 8 ? rnd_byte() : 0) == a[at])
+			;
+	}
+	want = sign(strcmp((char *)a, (char *)b));
+	if ((r = sign(ub_strcmp((char *)a, (char *)b))) != want)
+		return fail("strcmp", i, "%p, %p: %d, not %d", a, b, r, want);
+	want = sign(strncmp((char *)a, (char *)b, n));
+	if ((r = sign(ub_strncmp((char *)a, (char *)b, n))) != want)
+		return fail("strncmp", i, "%p, %p, %lu: %d, not %d", a, b, n, r, want);
+	return 0;
+}
+
+/* 'got' and 'want' are the same, 'len' bytes and SLACK either side */
+static int same_area(const char *what, unsigned long i, unsigned char *got,
+		unsigned char *want, unsigned long len)
+{
+	unsigned long k;
+
+	for (k = 0; k < len + 2 * SLACK; k++)
+		if (got[k] != want[k])
+			return fail(what, i, "byte %ld of %lu is %#x, not %#x",
+				(long)k - SLACK, len, got[k], want[k]);
+	return 0;
+}
+
+static int test_memset(unsigned long i)
+{
+	unsigned long len = rnd_len(), off = rnd() % 16;
+	unsigned char *a = pages + SLACK, *b = pages + 2 * page_size + SLACK;
+	int c = rnd_byte() | 0x100 * (rnd() % 4);
+
+	fill(a - SLACK, len + off + 2 * SLACK);
+	memcpy(b - SLACK, a - SLACK, len + off + 2 * SLACK);
+	if (ub_memset(a + off, c, len) != a + off)
+		return fail("memset", i, "wrong return value");
+	memset(b + off, c, len);
+	return same_area("memset", i, a + off - SLACK, b + off - SLACK, len);
+}
+
+static int test_memcpy(unsigned long i)
+{
+	unsigned int len = rnd_len();
+	unsigned long doff = rnd() % 16;
+	unsigned char *src = area(1, len);
+	unsigned char *a = pages + SLACK + doff;
+	unsigned char *b = pages + SLACK + page_size / 2 + doff;
+
+	fill(src, len);
+	fill(a - SLACK, len + 2 * SLACK);
+	memcpy(b - SLACK, a - SLACK, len + 2 * SLACK);
+	if (ub_memcpy(a, src, len) != a)
+		return fail("memcpy", i, "wrong return value");
+	memcpy(b, src, len);
+	return same_area("memcpy", i, a - SLACK, b - SLACK, len);
+}
+
+/* overlapping moves within one buffer, either way */
+static int test_memmove(unsigned long i)
+{
+	unsigned int len = rnd_len();
+	unsigned long span = len + MAX_LEN / 2;
+	unsigned char *a = pages + SLACK, *b = pages + SLACK + page_size / 2;
+	unsigned long so = rnd() % (span - len + 1), doff = rnd() % (span - len + 1);
+
+	fill(a - SLACK, span + 2 * SLACK);
+	memcpy(b - SLACK, a - SLACK, span + 2 * SLACK);
+	if (ub_memmove(a + doff, a + so, len) != a + doff)
+		return fail("memmove", i, "wrong return value");
+	memmove(b + doff, b + so, len);
+	if (memcmp(a - SLACK, b - SLACK, span + 2 * SLACK) != 0)
+		return fail("memmove", i, "dst +%lu, src +%lu, %u bytes: differs",
+			doff, so, len);
+	return 0;
+}
+
+static struct test {
+	const char	*name;
+	int		(*run)(unsigned long i);
+} tests[] = {
+	{ "strlen",	test_strlen },
+	{ "strnlen",	test_strnlen },
+	{ "memchr",	test_memchr },
+	{ "memcmp",	test_memcmp },
+	{ "strcmp",	test_strcmp },
+	{ "memset",	test_memset },
+	{ "memcpy",	test_memcpy },
+	{ "memmove",	test_memmove },
+};
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: strfuzz [-n cases] [-s seed]\n");
+	exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+	struct test *t;
+	unsigned long i;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:s:")) != -1) {
+		switch (c) {
+		case 'n': n_cases = strtoul(optarg, NULL, 0); break;
+		case 's': seed = strtoul(optarg, NULL, 0); break;
+		default: usage();
+		}
+	}
+
+	/* page, guard, page, guard */
+	page_size = sysconf(_SC_PAGESIZE);
+	pages = mmap(NULL, 4 * page_size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (pages == MAP_FAILED ||
+	    mprotect(pages + page_size, page_size, PROT_NONE) != 0 ||
+	    mprotect(pages + 3 * page_size, page_size, PROT_NONE) != 0) {
+		perror("strfuzz");
+		return 2;
+	}
+	signal(SIGSEGV, segv);
+
+	printf("%lu cases per function, seed %lu, %zu byte words\n",
+		n_cases, seed, sizeof(unsigned long));
+	for (t = tests; t < tests + sizeof(tests) / sizeof(tests[0]); t++) {
+		/* each function its own sequence, so -n does not shift the others */
+		rnd_state = seed * 0x9e3779b97f4a7c15ULL + (t - tests) + 1;
+		cur_name = t->name;
+		for (i = 0; i < n_cases; i++) {
+			cur_case = i;
+			if (t->run(i))
+				return 1;
+		}
+		printf("%-8s ok\n", t->name);
+	}
+	return 0;
+}
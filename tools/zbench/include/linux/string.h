@@ -0,0 +1,10 @@
+/*
+ * Host stand-in for <linux/string.h>: lib_generic/zlib.c only wants
+ * memcpy and memset.
+ */
+#ifndef _ZBENCH_LINUX_STRING_H_
+#define _ZBENCH_LINUX_STRING_H_
+
+#include <string.h>
+
+#endif	/* _ZBENCH_LINUX_STRING_H_ */
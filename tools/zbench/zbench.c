@@ -0,0 +1,195 @@
+/*
+ * Host benchmark of the inflate in lib_generic/zlib.c
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Each file.gz given is inflated as gunzip() in common/cmd_bootm.c
+ * does it, raw deflate after the gzip header with one Z_FINISH call,
+ * and the result is checked against 'file'.  The best of 'runs' runs
+ * is reported, as output MB/s.
+ *
+ *	zbench [-r runs] file.gz ...
+ *
+ * The Makefile builds it against ../../lib_generic/zlib.c, or against
+ * the file ZLIB names, so that two versions of zlib.c can be timed on
+ * the same data:
+ *
+ *	make bench
+ *	make clean; make bench ZLIB=/tmp/zlib-old.c
+ *
+ * These are host numbers: they show what a change to the decoder does
+ * to the work per byte, not what the 24K core with its 16KB D-cache
+ * makes of it.  "dbench" times gunzip() on the target.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+static int runs = 20;
+
+#define HEAD_CRC	2
+#define EXTRA_FIELD	4
+#define ORIG_NAME	8
+#define COMMENT		0x10
+#define RESERVED	0xe0
+
+#define DEFLATED	8
+
+static void *zalloc(void *x, unsigned items, unsigned size)
+{
+	return malloc((size_t)items * size);
+}
+
+static void zfree(void *x, void *addr, unsigned nb)
+{
+	free(addr);
+}
+
+/* gunzip() as in common/cmd_bootm.c, on malloc() instead of the arena */
+static int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
+{
+	z_stream s;
+	int r, i, flags;
+
+	i = 10;
+	flags = src[3];
+	if (src[2] != DEFLATED || (flags & RESERVED) != 0)
+		return -1;
+	if ((flags & EXTRA_FIELD) != 0)
+		i = 12 + src[10] + (src[11] << 8);
+	if ((flags & ORIG_NAME) != 0)
+		while (src[i++] != 0)
+			;
+	if ((flags & COMMENT) != 0)
+		while (src[i++] != 0)
+			;
+	if ((flags & HEAD_CRC) != 0)
+		i += 2;
+	if (i >= *lenp)
+		return -1;
+
+	memset(&s, 0, sizeof(s));
+	s.zalloc = zalloc;
+	s.zfree = zfree;
+	s.outcb = Z_NULL;
+	if (inflateInit2(&s, -MAX_WBITS) != Z_OK)
+		return -1;
+	s.next_in = src + i;
+	s.avail_in = *lenp - i;
+	s.next_out = dst;
+	s.avail_out = dstlen;
+	r = inflate(&s, Z_FINISH);
+	*lenp = s.next_out - (unsigned char *)dst;
+	inflateEnd(&s);
+	return (r == Z_OK || r == Z_STREAM_END) ? 0 : -1;
+}
+
+static unsigned char *load(const char *name, unsigned long *lenp)
+{
+	FILE *f = fopen(name, "rb");
+	unsigned char *p = NULL;
+	long len;
+
+	if (!f || fseek(f, 0, SEEK_END) != 0 || (len = ftell(f)) < 0 ||
+	    fseek(f, 0, SEEK_SET) != 0 || !(p = malloc(len + 1)) ||
+	    fread(p, 1, len, f) != (size_t)len) {
+		perror(name);
+		exit(2);
+	}
+	fclose(f);
+	*lenp = len;
+	return p;
+}
+
+static unsigned long long host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int bench(const char *gz)
+{
+	char name[256];
+	unsigned char *src, *want, *dst;
+	unsigned long src_len, want_len, len;
+	unsigned long long t, best = ~0ULL;
+	int i;
+
+	if (strlen(gz) < 4 || strlen(gz) >= sizeof(name) ||
+	    strcmp(gz + strlen(gz) - 3, ".gz") != 0) {
+		fprintf(stderr, "zbench: %s: not a .gz name\n", gz);
+		return 1;
+	}
+	strcpy(name, gz);
+	name[strlen(name) - 3] = 0;
+
+	src = load(gz, &src_len);
+	want = load(name, &want_len);
+	dst = malloc(want_len + 1);
+	if (!dst) {
+		fprintf(stderr, "zbench: out of memory\n");
+		exit(2);
+	}
+
+	for (i = 0; i < runs; i++) {
+		len = src_len;
+		memset(dst, 0, want_len + 1);
+		t = host_ns();
+		if (gunzip(dst, want_len + 1, src, &len) != 0 ||
+		    len != want_len || memcmp(dst, want, want_len) != 0) {
+			printf("%-20s FAIL\n", gz);
+			return 1;
+		}
+		t = host_ns() - t;
+		if (t < best)
+			best = t;
+	}
+	printf("%-20s %9lu %9lu %8.1f\n", gz, src_len, want_len,
+		(double)want_len * 1000 / (best ? best : 1));
+
+	free(src);
+	free(want);
+	free(dst);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int c, bad = 0;
+
+	while ((c = getopt(argc, argv, "r:")) != -1) {
+		switch (c) {
+		case 'r': runs = atoi(optarg); break;
+		default:
+			fprintf(stderr, "usage: zbench [-r runs] file.gz ...\n");
+			return 2;
+		}
+	}
+
+	printf("best of %d runs\n%-20s %9s %9s %8s\n", runs, "", "in", "out", "MB/s");
+	for (; optind < argc; optind++)
+		bad |= bench(argv[optind]);
+	return bad;
+}